@@ -2,6 +2,10 @@
 #define ACTOR_H_
 
 #include "GraphObject.h"
+#include "Cell.h"
+#include "ActorHandle.h"
+#include "Intent.h"
+#include "Random.h"
 class StudentWorld;
 
 /*
@@ -30,31 +34,59 @@ class StudentWorld;
         Exit
  */
 
+/*
+ Actor traits
+ 
+ What the world needs to know about an actor when it scans a cell is fixed
+ per type, so each class passes a constant bitmask to Actor and the world
+ tests bits instead of calling virtual predicates. Anything that changes
+ state (getting hit by a pea, being pushed) is a separate action method.
+ */
+
+const unsigned int TRAIT_AVATAR_OVERLAP = 1 << 0; // avatar (and robots) can share its square
+const unsigned int TRAIT_MARBLE_OVERLAP = 1 << 1; // a marble can be pushed onto it
+const unsigned int TRAIT_PUSHABLE = 1 << 2; // avatar pushes it instead of being blocked
+const unsigned int TRAIT_PEA_HIT = 1 << 3; // stops peas (and blocks line of sight)
+const unsigned int TRAIT_PEA_DAMAGE = 1 << 4; // takes damage from peas
+const unsigned int TRAIT_COLLECTABLE = 1 << 5; // thiefbots can pick it up
+const unsigned int TRAIT_THIEFBOT = 1 << 6;
+const unsigned int TRAIT_FACTORY = 1 << 7; // peas pass it while a thiefbot sits on it
+const unsigned int TRAIT_TIMED = 1 << 8; // acts every few ticks, woken up by the world's timing wheel
+const unsigned int TRAIT_ON_ENTER = 1 << 9; // avatarEntered() is called when the avatar steps onto it
+const unsigned int TRAIT_TERRAIN = 1 << 10; // seeking robots plan their way around it
+
 class Actor : public GraphObject {
 public:
-    Actor(StudentWorld* world, int imageID, double startX, double startY, int startDirection) : GraphObject(imageID, startX, startY, startDirection), m_world(world), m_status(true), canDetect(true) { setVisible(true); }
+    Actor(StudentWorld* world, int imageID, double startX, double startY, int startDirection, unsigned int traits);
     
     // pure virtual functions
     virtual void doSomething() = 0;
     
-    virtual bool avatarOverlap() = 0;
-    virtual bool marbleOverlap() = 0;
-    
-    virtual bool canPush() = 0;
-    virtual bool canPeaHit() = 0;
-    virtual bool canPeaDamage() = 0;
+    // actions
+    virtual void takePeaHit() {} // only called on actors with TRAIT_PEA_DAMAGE
+    virtual void avatarEntered() {} // only called on actors with TRAIT_ON_ENTER
     
-    virtual bool isCollectable() = 0;
-    virtual bool isThiefBot() = 0;
+    // two-phase update, only robots + factories plan anything (see Intent.h)
+    virtual void planIntent(Intent& intent, RandomGenerator&) const { intent.type = INTENT_NONE; }
+    virtual void applyIntent(const Intent&) {}
     
     // accessor functions
-    bool getStatus() { return m_status; }
+    bool getStatus() const { return m_status; }
     StudentWorld* getWorld() const { return m_world; }
     bool isObjectDetectable() { return canDetect; }
+    unsigned int getId() const { return m_id; }
+    Cell getCell() const { return m_cell; }
+    ActorHandle getHandle() const { return m_handle; }
+    int getPoolSlot() const { return m_poolSlot; }
+    Cell neighborCell(int dir) const; // NO_CELL past the edge of the world
+    bool hasTrait(unsigned int trait) const { return (m_traits & trait) != 0; }
     
     // modifier functions
-    void updatePos(double& x, double& y, const int dir);
-    void updateStatus(bool status) { m_status = status; }
+    void moveTo(Cell cell); // hides GraphObject::moveTo so the world's grid stays in sync
+    void setId(unsigned int id) { m_id = id; }
+    void setHandle(ActorHandle handle) { m_handle = handle; }
+    void setPoolSlot(int slot) { m_poolSlot = slot; }
+    void updateStatus(bool status);
     virtual void die() {
         updateStatus(false);
         setVisible(false);
@@ -66,13 +98,18 @@ private:
     StudentWorld* m_world; // pointer to StudentWorld
     bool m_status; // if actor is alive
     bool canDetect;
+    unsigned int m_id; // order the actor was added to the world
+    unsigned int m_traits; // TRAIT_ bits of the actor's type
+    Cell m_cell; // same square as getX()/getY()
+    ActorHandle m_handle; // NO_HANDLE until the world adds the actor
+    int m_poolSlot; // where its ActorPool constructed it
 };
 
 /* ///////////// DYNAMIC ACTORS /////////////*/
 
 class DynamicActor : public Actor {
 public:
-    DynamicActor(StudentWorld* world, int imageID, double startX, double startY, int startDirection, int hp) : Actor(world, imageID, startX, startY, startDirection), hitPoints(hp) {}
+    DynamicActor(StudentWorld* world, int imageID, double startX, double startY, int startDirection, int hp, unsigned int traits) : Actor(world, imageID, startX, startY, startDirection, traits), hitPoints(hp) {}
     
     // accessors
     int getHealth() const { return hitPoints; }
@@ -87,25 +124,19 @@ private:
 
 class Avatar : public DynamicActor {
 public:
-    Avatar(StudentWorld* world, double initX, double initY) : DynamicActor(world, IID_PLAYER, initX, initY, right, 20), numPeas(20) {}
-    virtual void doSomething();
-    virtual bool canPeaDamage();
-    
-    virtual bool avatarOverlap() { return false; }
-    virtual bool marbleOverlap() { return false; }
-   
-    virtual bool canPush() { return false; }
-    virtual bool canPeaHit() { return false; }
+    static constexpr unsigned int TRAITS = TRAIT_PEA_DAMAGE;
     
-    virtual bool isCollectable() { return false; }
-    virtual bool isThiefBot() { return false; }
+    Avatar(StudentWorld* world, double initX, double initY) : DynamicActor(world, IID_PLAYER, initX, initY, right, 20, TRAITS), numPeas(20) {}
+    virtual void doSomething();
+    virtual void takePeaHit();
     
     // accessors
     int getAmmo() const { return numPeas; }
     
     // mutators
-    void avatarMove(double x, double y);
+    void avatarMove(Cell cell);
     void updatePeas(int num) { numPeas += num; }
+    void setAmmo(int num) { numPeas = num; }
     void playerShoot();
     
 private:
@@ -117,14 +148,13 @@ private:
 
 class Robot : public DynamicActor {
 public:
-    Robot(StudentWorld* world, int imageID, double x, double y, int dir, int hp) : DynamicActor(world, imageID, x, y, dir, hp) {}
+    Robot(StudentWorld* world, int imageID, double x, double y, int dir, int hp, unsigned int traits) : DynamicActor(world, imageID, x, y, dir, hp, traits) {}
     
-    // accessors
-    bool canTakeAction() const;
+    virtual bool canShootPlayer() const; // player is in the line of fire
     
     // modifiers
     void reverseDirection();
-    virtual bool canShoot();
+    void shoot();
     virtual void die() = 0;
     
 private:
@@ -132,77 +162,66 @@ private:
 
 class RageBot : public Robot {
 public:
-    RageBot(StudentWorld* world, double x, double y, int dir) : Robot(world, IID_RAGEBOT, x, y, dir, 10) {}
+    static constexpr unsigned int TRAITS = TRAIT_PEA_HIT | TRAIT_PEA_DAMAGE | TRAIT_TIMED;
+    
+    RageBot(StudentWorld* world, double x, double y, int dir) : Robot(world, IID_RAGEBOT, x, y, dir, 10, TRAITS) {}
     virtual void doSomething();
-    virtual bool canPeaDamage();
-   
-    virtual bool avatarOverlap() { return false; }
-    virtual bool marbleOverlap() { return false; }
-    
-    virtual bool canPush() { return false; }
-    virtual bool canPeaHit() { return true; }
-    virtual bool isCollectable() { return false; }
-    virtual bool isThiefBot() { return false; }
+    virtual void takePeaHit();
     virtual void die();
     
+    virtual void planIntent(Intent& intent, RandomGenerator& rng) const;
+    virtual void applyIntent(const Intent& intent);
     
 private:
 };
 
 class ThiefBot : public Robot {
 public:
-    ThiefBot(StudentWorld* world, int imageID, double x, double y, int hp) : Robot(world, imageID, x, y, right, hp), distanceMoved(0), hasGoodie(false), m_goodie(nullptr) {
-        maxDistance = distanceBeforeTurning();
-    }
+    static constexpr unsigned int TRAITS = TRAIT_PEA_HIT | TRAIT_PEA_DAMAGE | TRAIT_THIEFBOT | TRAIT_TIMED;
+    
+    ThiefBot(StudentWorld* world, int imageID, double x, double y, int hp);
     
     virtual void doSomething();
-    virtual bool canPeaDamage();
+    virtual void takePeaHit();
     virtual void updateScore() = 0;
     
+    virtual void planIntent(Intent& intent, RandomGenerator& rng) const;
+    virtual void applyIntent(const Intent& intent);
+    
     // accessors
-    int getDistanceMoved() { return distanceMoved; }
-    int getMaxDistance() { return maxDistance; }
-    bool robotHasGoodie() { return hasGoodie; }
-    Actor* myGoodie() { return m_goodie; }
+    int getDistanceMoved() const { return distanceMoved; }
+    int getMaxDistance() const { return maxDistance; }
+    bool robotHasGoodie() const { return hasGoodie; }
+    Actor* myGoodie() const; // nullptr if the goodie is gone
     
     // modifiers
     void incrementDistanceMoved() { distanceMoved++; }
-    void resetDistanceMoved() { distanceMoved = 0; }
-    void resetMaxDistance() { maxDistance = distanceBeforeTurning(); }
+    void setDistances(int moved, int max) { distanceMoved = moved; maxDistance = max; }
     void gotGoodie() { hasGoodie = true; }
     void lostGoodie() { hasGoodie = false; }
-    void setGoodie(Actor* actor) { m_goodie = actor; }
+    void setGoodie(Actor* actor) { m_goodie = (actor != nullptr) ? actor->getHandle() : NO_HANDLE; }
     
     void doGoodieAction();
-    void moveGoodie(double x, double y);
+    void moveGoodie(Cell cell);
     virtual void die();
-    bool moveRobot(Actor* robot, double x, double y, int dir);
     
     // utility functions
-    int distanceBeforeTurning();
-    bool chanceToPickUpGoodie();
-    int randomDirection();
-    
-    // thiefbot traits
-    virtual bool avatarOverlap() { return false; }
-    virtual bool marbleOverlap() { return false; }
-    virtual bool canPush() { return false; }
-    virtual bool canPeaHit() { return true; }
-    virtual bool isCollectable() { return false; }
-    virtual bool isThiefBot() { return true; }
+    static int distanceBeforeTurning(RandomGenerator& rng);
+    static bool chanceToPickUpGoodie(RandomGenerator& rng);
+    static int randomDirection(RandomGenerator& rng);
     
 private:
     int distanceMoved;
     int maxDistance;
     bool hasGoodie;
-    Actor* m_goodie;
+    ActorHandle m_goodie;
 };
 
 class RegularThiefBot : public ThiefBot {
 public:
     RegularThiefBot(StudentWorld* world, double x, double y) : ThiefBot(world, IID_THIEFBOT, x, y, 5) {}
     virtual void updateScore();
-    virtual bool canShoot() { return false; }
+    virtual bool canShootPlayer() const { return false; }
     //virtual void die();
 private:
 };
@@ -219,16 +238,9 @@ private:
 
 class Interactable_Object : public Actor {
 public:
-    Interactable_Object(StudentWorld* world, int imageID, double startX, double startY) : Actor(world, imageID, startX, startY, none) {}
-    virtual bool avatarOverlap() { return true; }
-    virtual bool marbleOverlap() { return false; }
+    static constexpr unsigned int TRAITS = TRAIT_AVATAR_OVERLAP;
     
-    virtual bool canPeaDamage() { return false; }
-    virtual bool canPeaHit() { return false; }
-    virtual bool canPush() { return false; }
-    
-    virtual bool isCollectable() { return false; }
-    virtual bool isThiefBot() { return false; }
+    Interactable_Object(StudentWorld* world, int imageID, double startX, double startY, unsigned int traits = TRAITS) : Actor(world, imageID, startX, startY, none, traits) {}
 private:
 };
 
@@ -236,9 +248,12 @@ private:
 
 class Crystal : public Interactable_Object {
 public:
-    Crystal(StudentWorld* world, double x, double y) : Interactable_Object(world, IID_CRYSTAL, x, y) {}
-    virtual void doSomething();
-
+    static constexpr unsigned int TRAITS = Interactable_Object::TRAITS | TRAIT_ON_ENTER;
+    
+    Crystal(StudentWorld* world, double x, double y) : Interactable_Object(world, IID_CRYSTAL, x, y, TRAITS) {}
+    virtual void doSomething() { return; } // picked up when the avatar steps on it
+    virtual void avatarEntered();
+    
 private:
 };
 
@@ -246,12 +261,14 @@ private:
 
 class Goodie : public Interactable_Object {
 public:
-    Goodie(StudentWorld* world, int imageID, double x, double y) : Interactable_Object(world, imageID, x, y), canPlayerPickUp(true) {}
+    static constexpr unsigned int TRAITS = Interactable_Object::TRAITS | TRAIT_COLLECTABLE | TRAIT_ON_ENTER;
+    
+    Goodie(StudentWorld* world, int imageID, double x, double y) : Interactable_Object(world, imageID, x, y, TRAITS), canPlayerPickUp(true) {}
     virtual void useGoodie() = 0;
-    virtual void doSomething();
+    virtual void doSomething() { return; } // picked up when the avatar steps on it
+    virtual void avatarEntered();
     void playerCanPickUp() { canPlayerPickUp = true; }
     void playerCannotPickUp() { canPlayerPickUp = false; }
-    virtual bool isCollectable() { return true; }
     
 private:
     bool canPlayerPickUp;
@@ -282,115 +299,79 @@ private:
 
 class Pea : public Actor {
 public:
-    Pea(StudentWorld* world, double x, double y, int direction) : Actor(world, IID_PEA, x, y, direction), firstShot(true) {};
-    virtual void doSomething();
-    virtual bool canPeaDamage() { return false; }
+    static constexpr unsigned int TRAITS = 0;
     
-    virtual bool avatarOverlap() { return false; }
-    virtual bool marbleOverlap() { return false; }
+    Pea(StudentWorld* world, double x, double y, int direction) : Actor(world, IID_PEA, x, y, direction, TRAITS) {};
+    virtual void doSomething(); // the world only calls it when something might stop the pea
     
-    virtual bool canPush() { return false; }
-    virtual bool canPeaHit() { return false; }
-    
-    virtual bool isCollectable() { return false; }
-    virtual bool isThiefBot() { return false; }
-private:
-    bool firstShot;
+    // used by PeaPool to recycle peas
+    void reset(Cell cell, int direction);
+    void retire();
 };
 
 class Marble : public Actor {
 public:
-    Marble(StudentWorld* world, double x, double y) : Actor(world, IID_MARBLE, x, y, none), hitPoints(10) { }
-    virtual void doSomething();
+    static constexpr unsigned int TRAITS = TRAIT_PUSHABLE | TRAIT_PEA_HIT | TRAIT_PEA_DAMAGE | TRAIT_TERRAIN;
     
-    virtual bool avatarOverlap() { return false; }
-    virtual bool marbleOverlap() { return false; }
-    
-    virtual bool canPeaDamage();
-    virtual bool canPush();
-    virtual bool canPeaHit() { return true; }
-    
-    virtual bool isCollectable() { return false; }
-    virtual bool isThiefBot() { return false; }
+    Marble(StudentWorld* world, double x, double y) : Actor(world, IID_MARBLE, x, y, none, TRAITS), hitPoints(10) { }
+    virtual void doSomething();
+    virtual void takePeaHit();
     
     // utility functions
     bool pushMarble(int dir);
-
+    
+    int getHitPoints() const { return hitPoints; }
+    void setHitPoints(int hp) { hitPoints = hp; }
+    
 private:
     int hitPoints;
 };
 
 class Pit : public Actor {
 public:
-    Pit(StudentWorld* world, double x, double y) : Actor(world, IID_PIT, x, y, none) {}
-    virtual void doSomething();
-    
-    virtual bool avatarOverlap() { return false; }
-    virtual bool marbleOverlap() { return true; }
+    static constexpr unsigned int TRAITS = TRAIT_MARBLE_OVERLAP | TRAIT_TERRAIN;
     
-    virtual bool canPush() { return false; }
-    virtual bool canPeaDamage() { return false; }
-    virtual bool canPeaHit() { return false; }
+    Pit(StudentWorld* world, double x, double y) : Actor(world, IID_PIT, x, y, none, TRAITS) {}
+    virtual void doSomething();
     
-    virtual bool isCollectable() { return false; }
-    virtual bool isThiefBot() { return false; }
-
 private:
 };
 
 class ThiefBotFactory : public Actor {
 public:
-    ThiefBotFactory(StudentWorld* world, double x, double y, bool isMean) : Actor(world, IID_ROBOT_FACTORY, x, y, none), isMeanFactory(isMean) {}
-    virtual void doSomething();
+    static constexpr unsigned int TRAITS = TRAIT_PEA_HIT | TRAIT_FACTORY | TRAIT_TERRAIN;
     
-    virtual bool avatarOverlap() { return false; }
-    virtual bool marbleOverlap() { return false; }
-    
-    virtual bool canPeaDamage() { return false; }
-    virtual bool canPush() { return false; }
-    virtual bool canPeaHit(); 
+    ThiefBotFactory(StudentWorld* world, double x, double y, bool isMean) : Actor(world, IID_ROBOT_FACTORY, x, y, none, TRAITS), isMeanFactory(isMean) {}
+    virtual void doSomething();
     
-    virtual bool isCollectable() { return false; }
-    virtual bool isThiefBot() { return false; }
+    virtual void planIntent(Intent& intent, RandomGenerator& rng) const;
+    virtual void applyIntent(const Intent& intent);
     
-    bool isMeanThiefBotFactory() { return isMeanFactory; }
+    bool isMeanThiefBotFactory() const { return isMeanFactory; }
 private:
     bool isMeanFactory; // whether regular factory or mean factory
-    bool chanceCreateThiefBot(); // utility function
+    static bool chanceCreateThiefBot(RandomGenerator& rng); // utility function
 };
 
 class Wall : public Actor {
 public:
-    Wall(StudentWorld* world, double initX, double initY) : Actor(world, IID_WALL, initX, initY, none) {}
-    virtual void doSomething() { return; } // wall can't do anything
-    
-    virtual bool avatarOverlap() { return false; }
-    virtual bool marbleOverlap() { return false; }
+    static constexpr unsigned int TRAITS = TRAIT_PEA_HIT | TRAIT_TERRAIN;
     
-    virtual bool canPush() { return false; }
-    virtual bool canPeaDamage() { return false; }
-    virtual bool canPeaHit() { return true; }
+    Wall(StudentWorld* world, double initX, double initY) : Actor(world, IID_WALL, initX, initY, none, TRAITS) {}
+    virtual void doSomething() { return; } // wall can't do anything
     
-    virtual bool isCollectable() { return false; }
-    virtual bool isThiefBot() { return false; }
 private:
 };
 
 
 class Exit : public Actor {
 public:
-    Exit(StudentWorld* world, double x, double y) : Actor(world, IID_EXIT, x, y, none) { setVisible(false); }
-    virtual void doSomething();
-    
-    virtual bool avatarOverlap() { return true; }
-    virtual bool marbleOverlap() { return false; }
+    static constexpr unsigned int TRAITS = TRAIT_AVATAR_OVERLAP | TRAIT_ON_ENTER;
     
-    virtual bool canPush() { return false; }
-    virtual bool canPeaDamage() { return false; }
-    virtual bool canPeaHit() { return false; }
+    Exit(StudentWorld* world, double x, double y) : Actor(world, IID_EXIT, x, y, none, TRAITS) { setVisible(false); }
+    virtual void doSomething() { return; } // revealed by the world, used when the avatar steps on it
+    virtual void avatarEntered();
     
-    virtual bool isCollectable() { return false; }
-    virtual bool isThiefBot() { return false; }
 private:
 };
 
@@ -1,26 +1,35 @@
 // Actor.cpp
 #include "Actor.h"
 #include "StudentWorld.h"
-#include <cstdlib>
 
 /* ////////////// ACTOR //////////////////*/
 
-// update position function for all actors
-void Actor::updatePos(double& x, double& y, const int dir) {
-    switch (dir) {
-        case up:
-            y++;
-            break;
-        case down:
-            y--;
-            break;
-        case left:
-            x--;
-            break;
-        case right:
-            x++;
-            break;
-    }
+Actor::Actor(StudentWorld* world, int imageID, double startX, double startY, int startDirection, unsigned int traits)
+: GraphObject(imageID, startX, startY, startDirection), m_world(world), m_status(true), canDetect(true), m_id(0), m_traits(traits),
+  m_cell(world->cellAt(startX, startY)), m_handle(NO_HANDLE), m_poolSlot(-1)
+{
+    setVisible(true);
+}
+
+// an actor the world knows about that dies gets removed at the end of the tick
+void Actor::updateStatus(bool status) {
+    if (m_status && !status && m_id != 0)
+        getWorld()->actorDied(this);
+    m_status = status;
+}
+
+// the square next to the actor in direction dir
+Cell Actor::neighborCell(int dir) const {
+    return getWorld()->neighborCell(m_cell, dir);
+}
+
+// moves actor + tells the world so its occupancy grid stays up to date
+void Actor::moveTo(Cell cell) {
+    if (cell == NO_CELL) // nothing past the edge of the world
+        return;
+    getWorld()->updateOccupancy(this, m_cell, cell);
+    m_cell = cell;
+    GraphObject::moveTo(getWorld()->cellX(cell), getWorld()->cellY(cell));
 }
 
 /* ////////////// AVATAR //////////////////*/
@@ -28,26 +37,26 @@ void Actor::updatePos(double& x, double& y, const int dir) {
 // reads in input and moves avatar accordingly
 void Avatar::doSomething() {
     int ch;
-    if (getWorld()->getKey(ch)) {
+    if (getWorld()->getPlayerKey(ch)) {
         switch(ch) {
             case KEY_PRESS_LEFT: {
                 setDirection(left);
-                avatarMove(getX() - 1, getY());
+                avatarMove(neighborCell(left));
                 break;
             }
             case KEY_PRESS_RIGHT: {
                 setDirection(right);
-                avatarMove(getX() + 1, getY());
+                avatarMove(neighborCell(right));
                 break;
             }
             case KEY_PRESS_UP: {
                 setDirection(up);
-                avatarMove(getX(), getY() + 1);
+                avatarMove(neighborCell(up));
                 break;
             }
             case KEY_PRESS_DOWN: {
                 setDirection(down);
-                avatarMove(getX(), getY() - 1);
+                avatarMove(neighborCell(down));
                 break;
             }
             case KEY_PRESS_SPACE: {
@@ -58,35 +67,32 @@ void Avatar::doSomething() {
     }
 }
 
-// checks if movement is valid
-void Avatar::avatarMove(double x, double y) {
-    if (getWorld()->isInBounds(x, y))
-        moveTo(x, y);
+// checks if movement is valid, then lets whatever is in the new square react
+void Avatar::avatarMove(Cell cell) {
+    if (getWorld()->isInBounds(cell)) {
+        moveTo(cell);
+        getWorld()->avatarEnteredCell(cell);
+    }
 }
 
 // when the player presses space bar and shoots
 void Avatar::playerShoot() {
     if (numPeas > 0) {
-        double x = getX();
-        double y = getY();
         int dir = getDirection();
-        updatePos(x, y, dir);
-        
-        getWorld()->constructPea(x, y, dir);
+        getWorld()->constructPea(neighborCell(dir), dir);
         getWorld()->playSound(SOUND_PLAYER_FIRE);
         numPeas--;
     }
 }
 
 // how an avatar is attacked by pea
-bool Avatar::canPeaDamage() {
+void Avatar::takePeaHit() {
     updateHealth(-2); // loses 2 hp
     getWorld()->playSound(SOUND_PLAYER_IMPACT);
     if (getHealth() <= 0) {
         updateStatus(false);
         getWorld()->playSound(SOUND_PLAYER_DIE);
     }
-    return true;
 }
 
 /* ////////////// MARBLE //////////////////*/
@@ -96,29 +102,24 @@ void Marble::doSomething() {
         updateStatus(false);
 }
 
-// can only push if pushMarble returns true
-bool Marble::canPush() {
-    return pushMarble(getWorld()->getPlayerDirection());
-}
-
 // avatar pushes marble
 bool Marble::pushMarble(int dir) {
-    // get marble's current pos
-    double x = getX();
-    double y = getY();
-    updatePos(x, y, dir);
+    // square the marble would be pushed onto
+    Cell cell = neighborCell(dir);
    
     // move the marble if possible
-    if (getWorld()->canMarbleMove(this, x, y)) {
-        moveTo(x, y);
+    if (getWorld()->canMarbleMove(this, cell)) {
+        moveTo(cell);
         return true;
     }
     return false;
 }
 
-bool Marble::canPeaDamage() {
+void Marble::takePeaHit() {
+    bool wasWhole = hitPoints > 0;
     hitPoints -= 2;
-    return true;
+    if (wasWhole && hitPoints <= 0) // breaks on its next turn
+        getWorld()->marbleBroke(this);
 }
 
 /* /////////// ROBOTS ///////////*/
@@ -142,17 +143,8 @@ void Robot::reverseDirection() {
     }
 }
 
-bool Robot::canTakeAction() const {
-    int tickFreq = ((28 - getWorld()->getCurrLevel()) / 4);
-    if (tickFreq < 3) // least tickFreq is 3
-        tickFreq = 3;
-    
-    return (getWorld()->getTick() % tickFreq == 0);
-}
-
-// if robot can shoot player + shoot player
-bool Robot::canShoot() {
-   // shoot peas
+// if player is in the line of sight of the robot
+bool Robot::canShootPlayer() const {
    int dir = 0;
    switch(getDirection()) {
        case up:
@@ -168,54 +160,76 @@ bool Robot::canShoot() {
            dir = 4;
            break;
    }
+   return getWorld()->robotCanShootPlayer(getCell(), dir);
+}
 
-   // if player is in the line of sight of the robot
-   if (getWorld()->robotCanShootPlayer(getX(), getY(), dir)) {
-       double x = getX();
-       double y = getY();
-       int dir = getDirection();
-       updatePos(x, y, dir); // updated position where pea should be constructed
-
-       getWorld()->constructPea(x, y, dir);
-       getWorld()->playSound(SOUND_ENEMY_FIRE);
-       return true;
-   }
-   return false;
+// shoot peas
+void Robot::shoot() {
+   int dir = getDirection();
+   getWorld()->constructPea(neighborCell(dir), dir); // pea starts in front of the robot
+   getWorld()->playSound(SOUND_ENEMY_FIRE);
 }
 
 /* /////////// RAGEBOT //////////*/
 
 void RageBot::doSomething() {
-    if (!getStatus() || !canTakeAction()) // check if dead
+    Intent intent;
+    planIntent(intent, getWorld()->getRandom());
+    applyIntent(intent);
+}
+
+void RageBot::planIntent(Intent& intent, RandomGenerator&) const {
+    intent.type = INTENT_NONE;
+    if (!getStatus()) // check if dead, the world only wakes robots on the ticks they act
         return;
     
-    double x = getX();
-    double y = getY();
-    updatePos(x, y, getDirection());
+    Cell cell = neighborCell(getDirection());
+    int seek = getWorld()->isSeekingRobots() ? getWorld()->stepToward(this, NAVIGATE_TO_PLAYER) : none;
     
-    if (canShoot()) {
-        // function will shoot
+    if (canShootPlayer()) {
+        intent.type = INTENT_SHOOT;
+    }
+    else if (seek != none) { // heads for the player, facing the way it goes
+        intent.type = INTENT_MOVE;
+        intent.target = neighborCell(seek);
+        intent.direction = seek;
+    }
+    else if (getWorld()->canRobotMove(cell)) {
+        intent.type = INTENT_MOVE;
+        intent.target = cell;
+        intent.direction = getDirection();
     }
     else {
-        if (getWorld()->canRobotMove(this, x, y)) {
-            moveTo(x, y);
-        }
-        else {
+        intent.type = INTENT_TURN; // turns around
+    }
+}
+
+void RageBot::applyIntent(const Intent& intent) {
+    switch (intent.type) {
+        case INTENT_SHOOT:
+            shoot();
+            break;
+        case INTENT_MOVE:
+            setDirection(intent.direction);
+            if (getWorld()->canRobotMove(intent.target))
+                moveTo(intent.target);
+            else // something else moved in first
+                reverseDirection();
+            break;
+        case INTENT_TURN:
             reverseDirection();
-            updatePos(x, y, getDirection());
-            moveTo(x, y);
-        }
+            break;
+        default:
+            break;
     }
 }
 
-bool RageBot::canPeaDamage() {
+void RageBot::takePeaHit() {
     updateHealth(-2);
     getWorld()->playSound(SOUND_ROBOT_IMPACT);
     
     if (getHealth() == 0)
         die();
-    
-    return true;
 }
 
 void RageBot::die() {
@@ -226,19 +240,25 @@ void RageBot::die() {
 
 /* /////////// THIEFBOT //////////*/
 
-int ThiefBot::distanceBeforeTurning() {
+ThiefBot::ThiefBot(StudentWorld* world, int imageID, double x, double y, int hp)
+: Robot(world, imageID, x, y, right, hp, TRAITS), distanceMoved(0), hasGoodie(false), m_goodie(NO_HANDLE)
+{
+    maxDistance = distanceBeforeTurning(world->getRandom());
+}
+
+int ThiefBot::distanceBeforeTurning(RandomGenerator& rng) {
     // generate a random int between 1 and 6 inclusive
-    int rand_distance = rand() % 6 + 1;
+    int rand_distance = rng.randInt(1, 6);
     return rand_distance;
 }
 
-bool ThiefBot::chanceToPickUpGoodie() {
-    int randNum = rand() % 10 + 1;
+bool ThiefBot::chanceToPickUpGoodie(RandomGenerator& rng) {
+    int randNum = rng.randInt(1, 10);
     return randNum == 1;
 }
 
-int ThiefBot::randomDirection() {
-    int randNum = rand() % 4 + 1;
+int ThiefBot::randomDirection(RandomGenerator& rng) {
+    int randNum = rng.randInt(1, 4);
     switch(randNum) {
         case 1:
             return up;
@@ -252,93 +272,137 @@ int ThiefBot::randomDirection() {
     return -1;
 }
 
+Actor* ThiefBot::myGoodie() const {
+    return getWorld()->getActor(m_goodie);
+}
+
 // what happens when thiefbot is on the same square as a goodie
 void ThiefBot::doGoodieAction() {
     gotGoodie(); // sets hasGoodie to true
-    setGoodie(getWorld()->getActorAtPos(getX(), getY())); // set pointer to goodie
+    setGoodie(getWorld()->getActorAtPos(getCell())); // set pointer to goodie
     myGoodie()->setVisible(false); // goodie should now be invisible
     myGoodie()->setUndetectable(); // avatar/other actors can't detect it
     getWorld()->playSound(SOUND_ROBOT_MUNCH); // play munch sound
 }
 
 void ThiefBot::doSomething() {
-    // check if alive or supposed to rest
-    if (!getStatus() || !canTakeAction() || canShoot())
+    Intent intent;
+    planIntent(intent, getWorld()->getRandom());
+    applyIntent(intent);
+}
+
+void ThiefBot::planIntent(Intent& intent, RandomGenerator& rng) const {
+    intent.type = INTENT_NONE;
+    intent.maxDistance = 0;
+    
+    // check if alive, the world only wakes robots on the ticks they act
+    if (!getStatus())
+        return;
+    if (canShootPlayer()) {
+        intent.type = INTENT_SHOOT;
         return;
+    }
     
-    double x = getX();
-    double y = getY();
-    updatePos(x, y, getDirection());
+    Cell cell = neighborCell(getDirection());
     
     // check if on the same square as a goodie
-    if (!robotHasGoodie() && chanceToPickUpGoodie() && getWorld()->onSameSquareAsGoodie(getX(), getY()) ) {
-        doGoodieAction();
+    if (!robotHasGoodie() && chanceToPickUpGoodie(rng) && getWorld()->onSameSquareAsGoodie(getCell()) ) {
+        intent.type = INTENT_PICK_UP;
         return;
     }
+    // seeking: heads for the nearest goodie until it has one, waiting on top of it for the pick up
+    else if (getWorld()->isSeekingRobots() && !robotHasGoodie()) {
+        int seek = getWorld()->stepToward(this, NAVIGATE_TO_GOODIE);
+        if (seek != none) {
+            intent.type = INTENT_MOVE;
+            intent.target = neighborCell(seek);
+            intent.direction = seek;
+            return;
+        }
+        if (getWorld()->onSameSquareAsGoodie(getCell()))
+            return;
+    }
+    
     // has not yet moved distanceBeforeTurning
-    else if (getDistanceMoved() < getMaxDistance() && getWorld()->canRobotMove(this, x, y)) {
-        moveTo(x, y);
-        moveGoodie(x, y);
-        incrementDistanceMoved();
+    if (getDistanceMoved() < getMaxDistance() && getWorld()->canRobotMove(cell)) {
+        intent.type = INTENT_MOVE;
+        intent.target = cell;
+        intent.direction = getDirection();
         return;
     }
     // either has moved distanceBeforeTurning or encountered obstruction
-    else if (getDistanceMoved() == getMaxDistance() || !getWorld()->canRobotMove(this, x, y)) {
-        resetMaxDistance(); // new value of distanceBeforeTurning
-        resetDistanceMoved(); // distance moved set back to 0
+    else if (getDistanceMoved() == getMaxDistance() || !getWorld()->canRobotMove(cell)) {
+        intent.maxDistance = distanceBeforeTurning(rng); // new value of distanceBeforeTurning
         
         int directions[4] = {up, down, left, right};
-        int d = randomDirection();
+        int d = randomDirection(rng);
         
-        double x = getX();
-        double y = getY();
-        updatePos(x, y, d);
-        
-        if (moveRobot(this, x, y, d))
+        intent.type = INTENT_MOVE;
+        intent.direction = d;
+        intent.target = neighborCell(d);
+        if (getWorld()->canRobotMove(intent.target))
             return;
         
         for (int i = 0; i < 4; i++) { // trying the other directions
             if (directions[i] != d) { // except for the one already tried
-                double x = getX();
-                double y = getY();
-                updatePos(x, y, directions[i]);
-                if (moveRobot(this, x, y, directions[i]))
+                intent.direction = directions[i];
+                intent.target = neighborCell(directions[i]);
+                if (getWorld()->canRobotMove(intent.target))
                     return;
             }
         }
-        setDirection(d);
+        intent.type = INTENT_TURN;
+        intent.direction = d;
         return;
     }
 }
 
-void ThiefBot::moveGoodie(double x, double y) {
-    if (robotHasGoodie())
-        myGoodie()->moveTo(x, y); // goodie should move w/ robot
+void ThiefBot::applyIntent(const Intent& intent) {
+    if (intent.maxDistance != 0)
+        setDistances(0, intent.maxDistance); // distance moved set back to 0
+    
+    switch (intent.type) {
+        case INTENT_SHOOT:
+            shoot();
+            break;
+        case INTENT_PICK_UP:
+            doGoodieAction();
+            break;
+        case INTENT_MOVE:
+            setDirection(intent.direction);
+            if (getWorld()->canRobotMove(intent.target)) { // something else may have moved in first
+                moveTo(intent.target);
+                moveGoodie(intent.target);
+                incrementDistanceMoved();
+            }
+            break;
+        case INTENT_TURN:
+            setDirection(intent.direction);
+            break;
+        default:
+            break;
+    }
 }
 
-bool ThiefBot::moveRobot(Actor* robot, double x, double y, int dir) {
-    if (getWorld()->canRobotMove(robot, x, y)) {
-        setDirection(dir);
-        moveTo(x, y);
-        moveGoodie(x, y);
-        incrementDistanceMoved();
-        return true;
-    }
-    return false;
+void ThiefBot::moveGoodie(Cell cell) {
+    if (robotHasGoodie() && myGoodie() != nullptr)
+        myGoodie()->moveTo(cell); // goodie should move w/ robot
 }
 
-bool ThiefBot::canPeaDamage() {
+void ThiefBot::takePeaHit() {
     updateHealth(-2);
     getWorld()->playSound(SOUND_ROBOT_IMPACT);
     if (getHealth() <= 0)
         die();
-    return true;
 }
 
 void ThiefBot::die() {
     if (robotHasGoodie()) {
-        myGoodie()->setVisible(true);
-        myGoodie()->setBackToDetectable();
+        Actor* goodie = myGoodie();
+        if (goodie != nullptr) { // drop it where the robot died
+            goodie->setVisible(true);
+            goodie->setBackToDetectable();
+        }
         lostGoodie();
         setGoodie(nullptr);
     }
@@ -358,42 +422,39 @@ void MeanThiefBot::updateScore() {
 /* /////////// THIEFBOT FACTORY /////////*/
 
 void ThiefBotFactory::doSomething() {
-    double x = getX();
-    double y = getY();
-    
-    if (getWorld()->countSurroundingThiefBots(x, y) < 3 && chanceCreateThiefBot()) {
-        if (isMeanThiefBotFactory()) {
-            getWorld()->constructMeanThiefBot(x, y);
-            return;
-        }
-        else {
-            getWorld()->constructRegularThiefBot(x, y);
-            return;
-        }
-    }
-    return;
+    Intent intent;
+    planIntent(intent, getWorld()->getRandom());
+    applyIntent(intent);
 }
 
-bool ThiefBotFactory::canPeaHit() {
-    if (getWorld()->onSameSquareAsThiefBot(getX(), getY())) {
-        setUndetectable();
-        return false;
-    }
-    return true;
+void ThiefBotFactory::planIntent(Intent& intent, RandomGenerator& rng) const {
+    intent.type = INTENT_NONE;
+    if (getWorld()->countSurroundingThiefBots(getCell()) < 3 && chanceCreateThiefBot(rng))
+        intent.type = INTENT_SPAWN;
+}
+
+void ThiefBotFactory::applyIntent(const Intent& intent) {
+    if (intent.type != INTENT_SPAWN)
+        return;
+    
+    if (isMeanThiefBotFactory())
+        getWorld()->constructMeanThiefBot(getCell());
+    else
+        getWorld()->constructRegularThiefBot(getCell());
 }
 
-bool ThiefBotFactory::chanceCreateThiefBot() {
-    int chance = rand() % 50 + 1;
+bool ThiefBotFactory::chanceCreateThiefBot(RandomGenerator& rng) {
+    int chance = rng.randInt(1, 50);
     return chance == 1;
 }
 
 /* /////////// GOODIES ///////////////// */
 
-void Goodie::doSomething() {
+void Goodie::avatarEntered() {
     if (!getStatus())
         return;
     
-    if (canPlayerPickUp && getWorld()->onSameSquareAsPlayer(getX(), getY())) {
+    if (canPlayerPickUp) {
         getWorld()->playSound(SOUND_GOT_GOODIE);
         useGoodie();
         die();
@@ -413,47 +474,50 @@ void Ammo::useGoodie() {
 }
 
 // increase score by 50, notify studentWorld, remove crystal
-void Crystal::doSomething() {
+void Crystal::avatarEntered() {
     if (!getStatus()) // dead
         return;
     
-    if (getWorld()->onSameSquareAsPlayer(getX(), getY())) {
-        getWorld()->foundCrystal();
-        die();
-    }
+    getWorld()->foundCrystal();
+    die();
 }
 
 /* ////////////// PEA /////////////////*/
 
+// the exact check for one pea, the world skips peas on their first tick + moves the ones with a clear path itself
 void Pea::doSomething() {
     if (!getStatus()) // if dead
         return;
     
-    if (firstShot) {
-        firstShot = false;
-        return;
-    }
-    
-    int collisionType = getWorld()->overlapPea(getX(), getY());
+    int collisionType = getWorld()->overlapPea(getCell());
     if (collisionType == 1 || collisionType == 2)
         die();
-
-    // update position
-    int dir = getDirection();
-    double x = getX();
-    double y = getY();
-    
-    updatePos(x, y, dir);
     
     if (collisionType == 3)  // pea goes over - everything else
-        moveTo(x, y);
+        moveTo(neighborCell(getDirection()));
     
     // another check for updated position
-    int collisionType2 = getWorld()->overlapPea(getX(), getY());
+    int collisionType2 = getWorld()->overlapPea(getCell());
     if (collisionType2 == 1 || collisionType2 == 2)
         die();
 }
 
+// puts a recycled pea back in play at a new spot
+void Pea::reset(Cell cell, int direction) {
+    moveTo(cell); // not in the grid yet, the world adds it after
+    setDirection(direction);
+    updateStatus(true);
+    setBackToDetectable();
+    setVisible(true);
+}
+
+// hides a dead pea until the pool fires it again
+void Pea::retire() {
+    updateStatus(false);
+    setVisible(false);
+    setId(0);
+}
+
 /* ///////////// PIT & EXIT ///////////////*/
 
 void Pit::doSomething() {
@@ -461,14 +525,11 @@ void Pit::doSomething() {
         return;
 }
 
-// if all crystals collected, make exit visible
-// once player is on exit, level has been completed
-void Exit::doSomething() {
-    if (getWorld()->numCrystals() == 0) {
-        setVisible(true);
-        if (getWorld()->onSameSquareAsPlayer(getX(), getY()))
-            getWorld()->levelCompleted();
-    }
+// once all crystals are collected, stepping on the exit completes the level
+// the world makes it visible when the last crystal is found
+void Exit::avatarEntered() {
+    if (getWorld()->numCrystals() == 0)
+        getWorld()->levelCompleted();
 }
 
 
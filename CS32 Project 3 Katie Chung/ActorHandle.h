@@ -0,0 +1,84 @@
+#ifndef ACTORHANDLE_H_
+#define ACTORHANDLE_H_
+
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+class Actor;
+
+/*
+ A reference to an actor that knows when the actor is gone.
+
+ A handle is an index into the world's HandleTable plus the generation that
+ entry had when the actor was added. Removing the actor bumps the generation,
+ so any handle still pointing at it stops resolving instead of dangling, even
+ after the entry (or the pool slot) is reused by another actor.
+ */
+
+struct ActorHandle {
+    uint32_t index;
+    uint32_t generation; // never 0 for a live actor
+
+    bool operator==(const ActorHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const ActorHandle& other) const { return !(*this == other); }
+};
+
+const ActorHandle NO_HANDLE = { 0, 0 };
+
+class HandleTable {
+public:
+    // gives actor a new handle
+    ActorHandle add(Actor* actor) {
+        uint32_t index;
+        if (!m_free.empty()) {
+            index = m_free.back();
+            m_free.pop_back();
+        }
+        else {
+            index = m_entries.size();
+            m_entries.push_back(Entry { nullptr, 1 });
+        }
+        m_entries[index].actor = actor;
+        return ActorHandle { index, m_entries[index].generation };
+    }
+
+    // every handle to the entry's actor stops resolving
+    void remove(ActorHandle handle) {
+        if (get(handle) == nullptr)
+            return;
+        m_entries[handle.index].actor = nullptr;
+        m_entries[handle.index].generation++;
+        m_free.push_back(handle.index);
+    }
+
+    // the actor handle refers to, nullptr if it has been removed
+    Actor* get(ActorHandle handle) const {
+        if (handle.index >= m_entries.size() || m_entries[handle.index].generation != handle.generation)
+            return nullptr;
+        return m_entries[handle.index].actor;
+    }
+
+    // removes every actor, generations keep counting so old handles stay dead
+    void clear() {
+        m_free.clear();
+        for (size_t i = m_entries.size(); i-- > 0; ) {
+            if (m_entries[i].actor != nullptr) {
+                m_entries[i].actor = nullptr;
+                m_entries[i].generation++;
+            }
+            m_free.push_back(i);
+        }
+    }
+
+private:
+    struct Entry {
+        Actor* actor;
+        uint32_t generation;
+    };
+
+    vector<Entry> m_entries;
+    vector<uint32_t> m_free; // entries with no actor
+};
+
+#endif // ACTORHANDLE_H_
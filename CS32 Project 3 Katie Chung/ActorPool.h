@@ -0,0 +1,162 @@
+#ifndef ACTORPOOL_H_
+#define ACTORPOOL_H_
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <utility>
+#include <mutex>
+using namespace std;
+
+// GraphObject registers every object in one global set, so constructing or
+// destroying actors has to be serialized when several worlds run at once
+inline mutex& graphObjectMutex() {
+    static mutex m;
+    return m;
+}
+
+/*
+ Storage for every actor of one concrete type.
+
+ Actors are constructed in place inside fixed-size chunks, so actors of the
+ same type sit next to each other in memory. Chunks are never moved or freed
+ until the pool is destroyed, which means a pointer to an actor (its handle)
+ stays valid until that actor is removed. create() always uses the lowest
+ free slot, so which slot an actor lands in only depends on which slots are
+ in use, and a snapshot can put every actor back in the same place. Each
+ actor is told its slot, so destroy() goes straight to it.
+ */
+
+template <typename T>
+class ActorPool {
+public:
+    ActorPool() : m_count(0), m_firstFree(0) {}
+    ~ActorPool() { clear(); }
+
+    // constructs a new actor in the lowest free slot
+    template <typename... Args>
+    T* create(Args&&... args) {
+        return createAt(findFreeSlot(), std::forward<Args>(args)...);
+    }
+
+    // constructs a new actor in a given slot, which must be free
+    template <typename... Args>
+    T* createAt(int slot, Args&&... args) {
+        while ((int)m_chunks.size() <= slot / CHUNK_SIZE)
+            addChunk();
+
+        Chunk& chunk = *m_chunks[slot / CHUNK_SIZE];
+        T* actor;
+        {
+            lock_guard<mutex> lock(graphObjectMutex());
+            actor = new (chunk.slot(slot % CHUNK_SIZE)) T(std::forward<Args>(args)...);
+        }
+        actor->setPoolSlot(slot);
+        chunk.used[slot % CHUNK_SIZE] = true;
+        chunk.count++;
+        m_count++;
+        return actor;
+    }
+
+    // allocates enough chunks to hold count actors without growing
+    void reserve(int count) {
+        while ((int)(m_chunks.size() * CHUNK_SIZE) < count)
+            addChunk();
+    }
+
+    // calls func on every actor in slot order, stops early if func returns false
+    template <typename F>
+    bool forEach(F func) {
+        for (size_t c = 0; c < m_chunks.size(); c++) {
+            Chunk& chunk = *m_chunks[c];
+            for (int i = 0; i < CHUNK_SIZE; i++) {
+                if (chunk.used[i] && !func(chunk.get(i)))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // same as forEach, but func is also given the actor's slot
+    template <typename F>
+    bool forEachWithSlot(F func) {
+        for (size_t c = 0; c < m_chunks.size(); c++) {
+            Chunk& chunk = *m_chunks[c];
+            for (int i = 0; i < CHUNK_SIZE; i++) {
+                if (chunk.used[i] && !func(chunk.get(i), int(c * CHUNK_SIZE + i)))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // destroys one actor, which has to belong to this pool
+    void destroy(T* actor) {
+        int slot = actor->getPoolSlot();
+        release(slot / CHUNK_SIZE, slot % CHUNK_SIZE);
+    }
+
+    // destroys every actor but keeps the chunks for the next level
+    void clear() {
+        for (size_t c = 0; c < m_chunks.size(); c++) {
+            for (int i = 0; i < CHUNK_SIZE; i++) {
+                if (m_chunks[c]->used[i])
+                    release(c, i);
+            }
+        }
+    }
+
+    int size() const { return m_count; }
+
+private:
+    static const int CHUNK_SIZE = 64;
+
+    struct Chunk {
+        alignas(T) unsigned char storage[CHUNK_SIZE][sizeof(T)];
+        bool used[CHUNK_SIZE];
+        int count; // slots in use
+
+        void* slot(int i) { return storage[i]; }
+        T* get(int i) { return reinterpret_cast<T*>(storage[i]); }
+    };
+
+    void addChunk() {
+        m_chunks.push_back(unique_ptr<Chunk>(new Chunk));
+        for (int i = 0; i < CHUNK_SIZE; i++)
+            m_chunks.back()->used[i] = false;
+        m_chunks.back()->count = 0;
+    }
+
+    // lowest unused slot, past the last chunk if they are all full
+    int findFreeSlot() {
+        size_t c = m_firstFree;
+        while (c < m_chunks.size() && m_chunks[c]->count == CHUNK_SIZE)
+            c++;
+        m_firstFree = c;
+        if (c == m_chunks.size())
+            return c * CHUNK_SIZE;
+
+        int i = 0;
+        while (m_chunks[c]->used[i])
+            i++;
+        return c * CHUNK_SIZE + i;
+    }
+
+    void release(size_t c, int i) {
+        {
+            lock_guard<mutex> lock(graphObjectMutex());
+            m_chunks[c]->get(i)->~T();
+        }
+        m_chunks[c]->used[i] = false;
+        m_chunks[c]->count--;
+        m_count--;
+        if (c < m_firstFree)
+            m_firstFree = c;
+    }
+
+    vector<unique_ptr<Chunk>> m_chunks;
+    int m_count;
+    size_t m_firstFree; // no chunk before this one has a free slot
+};
+
+#endif // ACTORPOOL_H_
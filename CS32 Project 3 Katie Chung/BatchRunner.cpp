@@ -0,0 +1,78 @@
+#include "BatchRunner.h"
+#include "InputSource.h"
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <memory>
+using namespace std;
+
+// a worker's queue of job indices
+struct JobQueue {
+    mutex lock;
+    deque<int> jobs;
+};
+
+// takes a job from the back of the worker's own queue
+static bool popOwn(JobQueue& queue, int& job) {
+    lock_guard<mutex> guard(queue.lock);
+    if (queue.jobs.empty())
+        return false;
+    job = queue.jobs.back();
+    queue.jobs.pop_back();
+    return true;
+}
+
+// takes a job from the front of another worker's queue
+static bool steal(vector<unique_ptr<JobQueue>>& queues, int self, int& job) {
+    int n = queues.size();
+    for (int i = 1; i < n; i++) {
+        JobQueue& victim = *queues[(self + i) % n];
+        lock_guard<mutex> guard(victim.lock);
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+BatchRunner::BatchRunner(string assetPath, int numThreads)
+: m_assetPath(assetPath), m_numThreads(numThreads)
+{
+    if (m_numThreads <= 0)
+        m_numThreads = thread::hardware_concurrency();
+    if (m_numThreads <= 0)
+        m_numThreads = 1;
+}
+
+vector<HeadlessResult> BatchRunner::run(const vector<BatchJob>& jobs) {
+    vector<HeadlessResult> results(jobs.size());
+    
+    // deal the jobs out round-robin
+    vector<unique_ptr<JobQueue>> queues;
+    for (int i = 0; i < m_numThreads; i++)
+        queues.push_back(unique_ptr<JobQueue>(new JobQueue));
+    for (size_t j = 0; j < jobs.size(); j++)
+        queues[j % m_numThreads]->jobs.push_back(j);
+    
+    // no new jobs show up once the run starts, so a worker is done when it can't find one
+    auto worker = [&](int self) {
+        int job;
+        while (popOwn(*queues[self], job) || steal(queues, self, job)) {
+            const BatchJob& b = jobs[job];
+            ScriptedInput input(b.keys);
+            HeadlessDriver driver(m_assetPath, b.level, b.seed, &input);
+            results[job] = driver.run(b.maxTicks);
+        }
+    };
+    
+    vector<thread> threads;
+    for (int i = 1; i < m_numThreads; i++)
+        threads.push_back(thread(worker, i));
+    worker(0); // this thread works too
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+    
+    return results;
+}
@@ -0,0 +1,42 @@
+#ifndef BATCHRUNNER_H_
+#define BATCHRUNNER_H_
+
+#include "HeadlessDriver.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+// one headless run to do
+struct BatchJob {
+    int level;
+    uint64_t seed;
+    vector<int> keys; // scripted input, one key per tick (0 = no key)
+    int maxTicks;
+};
+
+/*
+ Runs many independent headless worlds across a pool of threads.
+
+ Every job gets its own StudentWorld, random generator and input, so jobs
+ share nothing except GraphObject's global registry, which ActorPool guards.
+ Jobs are dealt out round-robin to per-thread queues; a thread works from
+ the back of its own queue and steals from the front of another thread's
+ queue once its own runs dry, so long levels don't leave cores idle.
+ */
+
+class BatchRunner {
+public:
+    BatchRunner(string assetPath, int numThreads = 0); // 0 means one per core
+    
+    // results come back in the same order as jobs
+    vector<HeadlessResult> run(const vector<BatchJob>& jobs);
+    
+    int getThreadCount() const { return m_numThreads; }
+    
+private:
+    string m_assetPath;
+    int m_numThreads;
+};
+
+#endif // BATCHRUNNER_H_
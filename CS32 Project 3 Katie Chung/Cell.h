@@ -0,0 +1,20 @@
+#ifndef CELL_H_
+#define CELL_H_
+
+#include <cstdint>
+
+/*
+ One square of the maze packed into an integer.
+
+ A cell is the chunk the square is in plus the square's index inside that
+ chunk (see ChunkGrid.h), so looking up a square is two array indexes and
+ two positions are compared with one integer compare. Only the world knows
+ how big it is, so packing and unpacking go through StudentWorld::cellAt,
+ cellX, cellY and neighborCell.
+ */
+
+typedef uint32_t Cell;
+
+const Cell NO_CELL = 0xFFFFFFFF; // off the edge of the world
+
+#endif // CELL_H_
@@ -0,0 +1,134 @@
+#ifndef CHUNKGRID_H_
+#define CHUNKGRID_H_
+
+#include "Cell.h"
+#include "ActorHandle.h"
+#include <vector>
+#include <memory>
+using namespace std;
+
+class Actor;
+
+/*
+ The world's per-square storage, split into square chunks.
+
+ A chunk is only allocated the first time something is stored in one of its
+ squares, so parts of a big map nothing has touched cost one null pointer
+ each. Cells are packed chunk first (chunk << WORLD_CHUNK_BITS | square in
+ the chunk) and the number of chunks across is rounded up to a power of two,
+ so finding a cell's chunk and unpacking x and y are shifts and masks.
+ */
+
+const int WORLD_CHUNK_SHIFT = 4;
+const int WORLD_CHUNK_SIZE = 1 << WORLD_CHUNK_SHIFT; // squares along each side of a chunk
+const int WORLD_CHUNK_BITS = 2 * WORLD_CHUNK_SHIFT; // low bits of a cell, the square in its chunk
+const int WORLD_CHUNK_CELLS = 1 << WORLD_CHUNK_BITS;
+
+struct WorldChunk {
+    WorldChunk() : blockerCount(), nearbyThiefBots(), terrainCount() {}
+
+    void clear() {
+        for (int i = 0; i < WORLD_CHUNK_CELLS; i++) {
+            actors[i].clear();
+            blockerCount[i] = 0;
+            nearbyThiefBots[i] = 0;
+            terrainCount[i] = 0;
+        }
+        factories.clear();
+        sleepers.clear();
+    }
+
+    vector<Actor*> actors[WORLD_CHUNK_CELLS]; // actors in each square, kept in the order they were added
+    int blockerCount[WORLD_CHUNK_CELLS]; // pea-blocking actors in each square
+    int nearbyThiefBots[WORLD_CHUNK_CELLS]; // thiefbots within 2 squares of each square
+    int terrainCount[WORLD_CHUNK_CELLS]; // walls, marbles, pits + factories in each square
+    vector<Actor*> factories; // factories never move, so each one is listed where it stands
+    vector<ActorHandle> sleepers; // robots that came due while the chunk was outside the active region
+};
+
+class ChunkGrid {
+public:
+    ChunkGrid() : m_width(0), m_height(0), m_shiftX(0), m_chunksWide(0), m_chunksHigh(0) {}
+
+    // sets the size of the world in squares, frees every chunk
+    void resize(int width, int height) {
+        m_width = width;
+        m_height = height;
+        m_chunksWide = (width + WORLD_CHUNK_SIZE - 1) >> WORLD_CHUNK_SHIFT;
+        m_chunksHigh = (height + WORLD_CHUNK_SIZE - 1) >> WORLD_CHUNK_SHIFT;
+        m_shiftX = 0;
+        while ((1 << m_shiftX) < m_chunksWide)
+            m_shiftX++;
+
+        m_chunks.clear();
+        m_chunks.resize(size_t(m_chunksHigh) << m_shiftX);
+    }
+
+    // empties every chunk, keeping its memory for the next try at the level
+    void clear() {
+        for (size_t i = 0; i < m_chunks.size(); i++) {
+            if (m_chunks[i] != nullptr)
+                m_chunks[i]->clear();
+        }
+    }
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+    // cells, x + y must be inside the world
+    Cell pack(int x, int y) const {
+        uint32_t chunk = chunkAt(x >> WORLD_CHUNK_SHIFT, y >> WORLD_CHUNK_SHIFT);
+        uint32_t square = ((y & (WORLD_CHUNK_SIZE - 1)) << WORLD_CHUNK_SHIFT) | (x & (WORLD_CHUNK_SIZE - 1));
+        return Cell((chunk << WORLD_CHUNK_BITS) | square);
+    }
+    int cellX(Cell cell) const {
+        return (chunkX(chunkOf(cell)) << WORLD_CHUNK_SHIFT) | (cell & (WORLD_CHUNK_SIZE - 1));
+    }
+    int cellY(Cell cell) const {
+        return (chunkY(chunkOf(cell)) << WORLD_CHUNK_SHIFT) | ((cell >> WORLD_CHUNK_SHIFT) & (WORLD_CHUNK_SIZE - 1));
+    }
+
+    // chunks, numbered chunkY << shift | chunkX
+    int chunksWide() const { return m_chunksWide; }
+    int chunksHigh() const { return m_chunksHigh; }
+    int chunkAt(int chunkX, int chunkY) const { return (chunkY << m_shiftX) | chunkX; }
+    int chunkX(int chunk) const { return chunk & ((1 << m_shiftX) - 1); }
+    int chunkY(int chunk) const { return chunk >> m_shiftX; }
+    int chunkOf(Cell cell) const { return cell >> WORLD_CHUNK_BITS; }
+    static int squareOf(Cell cell) { return cell & (WORLD_CHUNK_CELLS - 1); }
+
+    // nullptr if nothing has been stored in the chunk yet
+    WorldChunk* find(int chunk) const { return m_chunks[chunk].get(); }
+
+    // allocates the chunk the first time it is asked for
+    WorldChunk& get(int chunk) {
+        if (m_chunks[chunk] == nullptr)
+            m_chunks[chunk].reset(new WorldChunk);
+        return *m_chunks[chunk];
+    }
+
+    // actors in one square, in the order they were added
+    // never allocates, so queries (including ones from the parallel planning pass) leave the chunk table alone
+    const vector<Actor*>& actorsAt(Cell cell) const {
+        const WorldChunk* chunk = find(chunkOf(cell));
+        return chunk != nullptr ? chunk->actors[squareOf(cell)] : m_none;
+    }
+
+    int allocatedChunks() const {
+        int count = 0;
+        for (size_t i = 0; i < m_chunks.size(); i++)
+            count += m_chunks[i] != nullptr;
+        return count;
+    }
+
+private:
+    int m_width; // size of the world in squares
+    int m_height;
+    int m_shiftX; // log2 of the chunks in a row, rounded up
+    int m_chunksWide; // chunks that hold part of the world
+    int m_chunksHigh;
+    vector<unique_ptr<WorldChunk>> m_chunks;
+    vector<Actor*> m_none; // what an unallocated square holds
+};
+
+#endif // CHUNKGRID_H_
@@ -0,0 +1,97 @@
+#ifndef DISTANCEFIELD_H_
+#define DISTANCEFIELD_H_
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+using namespace std;
+
+const int NO_DISTANCE = 0x7FFFFFFF; // the search never reached the square
+
+/*
+ Steps from every square of a rectangle to the nearest of a set of targets.
+
+ One breadth-first search from all the targets at once fills in the whole
+ rectangle, so any number of robots can each look up which way to go in
+ O(1) instead of searching for themselves. The search goes around squares
+ the caller says are blocked, but always starts from the targets even if
+ one stands on a blocked square. The distances only depend on the
+ rectangle, the targets and the blocked squares, so the world keeps the
+ inputs of the last build and skips building again while none of them have
+ changed.
+ */
+
+class DistanceField {
+public:
+    DistanceField() : m_left(0), m_bottom(0), m_width(0), m_height(0), m_terrainVersion(0), m_built(false) {}
+
+    // true if the last build was from the same inputs, terrainVersion changes whenever blocked squares do
+    bool isBuiltFor(int left, int bottom, int width, int height, const vector<pair<int, int>>& targets, uint64_t terrainVersion) const {
+        return m_built && left == m_left && bottom == m_bottom && width == m_width && height == m_height &&
+            terrainVersion == m_terrainVersion && targets == m_targets;
+    }
+
+    // searches the rectangle from (left, bottom), blocked(x, y) says if a square can't be walked through
+    template <typename Blocked>
+    void build(int left, int bottom, int width, int height, const vector<pair<int, int>>& targets, uint64_t terrainVersion, Blocked blocked) {
+        m_left = left;
+        m_bottom = bottom;
+        m_width = width;
+        m_height = height;
+        m_targets = targets;
+        m_terrainVersion = terrainVersion;
+        m_built = true;
+
+        m_distance.assign(size_t(width) * height, NO_DISTANCE);
+        m_queue.clear();
+        for (size_t i = 0; i < targets.size(); i++) {
+            int x = targets[i].first - left;
+            int y = targets[i].second - bottom;
+            if (x < 0 || y < 0 || x >= width || y >= height || m_distance[y * width + x] == 0)
+                continue;
+            m_distance[y * width + x] = 0;
+            m_queue.push_back(y * width + x);
+        }
+
+        for (size_t head = 0; head < m_queue.size(); head++) {
+            int square = m_queue[head];
+            int x = square % width;
+            int y = square / width;
+            int next = m_distance[square] + 1;
+            int neighbors[4] = { square - 1, square + 1, square - width, square + width };
+            bool inside[4] = { x > 0, x < width - 1, y > 0, y < height - 1 };
+            int offsetX[4] = { -1, 1, 0, 0 };
+            int offsetY[4] = { 0, 0, -1, 1 };
+            for (int d = 0; d < 4; d++) {
+                if (!inside[d] || m_distance[neighbors[d]] != NO_DISTANCE)
+                    continue;
+                if (blocked(left + x + offsetX[d], bottom + y + offsetY[d]))
+                    continue;
+                m_distance[neighbors[d]] = next;
+                m_queue.push_back(neighbors[d]);
+            }
+        }
+    }
+
+    // steps from world square (x, y) to the nearest target, NO_DISTANCE if it can't get there or is outside the field
+    int distance(int x, int y) const {
+        x -= m_left;
+        y -= m_bottom;
+        if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+            return NO_DISTANCE;
+        return m_distance[y * m_width + x];
+    }
+
+private:
+    int m_left; // world square the rectangle starts at
+    int m_bottom;
+    int m_width;
+    int m_height;
+    vector<pair<int, int>> m_targets; // as of the last build
+    uint64_t m_terrainVersion;
+    bool m_built;
+    vector<int> m_distance; // row by row from (m_left, m_bottom)
+    vector<int> m_queue; // squares in the order the search reached them
+};
+
+#endif // DISTANCEFIELD_H_
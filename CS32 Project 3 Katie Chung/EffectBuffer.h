@@ -0,0 +1,59 @@
+#ifndef EFFECTBUFFER_H_
+#define EFFECTBUFFER_H_
+
+#include "Cell.h"
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+/*
+ Effects actors ask for during a tick.
+
+ Sounds, score and new actors used to be applied straight from inside
+ doSomething, changing the world and the pools while they were being walked.
+ Now they are queued here and StudentWorld::applyEffects applies them all
+ at once after every actor has had its turn. A sound asked for more than
+ once in a tick is only played once.
+ */
+
+enum SpawnType {
+    SPAWN_PEA,
+    SPAWN_REGULAR_THIEFBOT,
+    SPAWN_MEAN_THIEFBOT
+};
+
+struct SpawnEffect {
+    SpawnType type;
+    Cell cell;
+    int direction; // only used by peas
+};
+
+class EffectBuffer {
+public:
+    EffectBuffer() : m_score(0) {}
+
+    void playSound(int soundID) {
+        if (find(m_sounds.begin(), m_sounds.end(), soundID) == m_sounds.end())
+            m_sounds.push_back(soundID);
+    }
+    void increaseScore(unsigned int amount) { m_score += amount; }
+    void spawn(SpawnType type, Cell cell, int direction) { m_spawns.push_back(SpawnEffect { type, cell, direction }); }
+
+    const vector<int>& getSounds() const { return m_sounds; } // in the order they were first asked for
+    unsigned int getScore() const { return m_score; }
+    const vector<SpawnEffect>& getSpawns() const { return m_spawns; }
+
+    // empties the buffer, keeping its memory for the next tick
+    void clear() {
+        m_sounds.clear();
+        m_score = 0;
+        m_spawns.clear();
+    }
+
+private:
+    vector<int> m_sounds;
+    unsigned int m_score;
+    vector<SpawnEffect> m_spawns;
+};
+
+#endif // EFFECTBUFFER_H_
@@ -0,0 +1,168 @@
+#include "GameEnv.h"
+#include "Actor.h"
+#include <algorithm>
+using namespace std;
+
+// the key an action presses, 0 for none
+static int actionKey(int action) {
+    switch (action) {
+        case ENV_LEFT:
+            return KEY_PRESS_LEFT;
+        case ENV_RIGHT:
+            return KEY_PRESS_RIGHT;
+        case ENV_UP:
+            return KEY_PRESS_UP;
+        case ENV_DOWN:
+            return KEY_PRESS_DOWN;
+        case ENV_FIRE:
+            return KEY_PRESS_SPACE;
+    }
+    return 0;
+}
+
+// the plane an actor is drawn on, -1 if it isn't shown
+static int planeOf(const Actor* actor) {
+    switch (actor->getID()) {
+        case IID_WALL:
+            return OBS_WALL;
+        case IID_EXIT:
+            return OBS_EXIT;
+        case IID_RAGEBOT:
+            return OBS_RAGEBOT;
+        case IID_THIEFBOT:
+            return OBS_THIEFBOT;
+        case IID_MEAN_THIEFBOT:
+            return OBS_MEAN_THIEFBOT;
+        case IID_ROBOT_FACTORY:
+            return static_cast<const ThiefBotFactory*>(actor)->isMeanThiefBotFactory() ? OBS_MEAN_FACTORY : OBS_FACTORY;
+        case IID_MARBLE:
+            return OBS_MARBLE;
+        case IID_PIT:
+            return OBS_PIT;
+        case IID_CRYSTAL:
+            return OBS_CRYSTAL;
+        case IID_RESTORE_HEALTH:
+            return OBS_RESTORE_HEALTH;
+        case IID_EXTRA_LIFE:
+            return OBS_EXTRA_LIFE;
+        case IID_AMMO:
+            return OBS_AMMO;
+        case IID_PEA:
+            return OBS_PEA;
+    }
+    return -1;
+}
+
+GameEnv::GameEnv(string assetPath, int numEnvs, int numThreads)
+: m_assetPath(assetPath), m_level(0), m_maxEpisodeTicks(0),
+  m_observations(size_t(max(numEnvs, 0)) * OBS_SIZE, 0.0f), m_rewards(max(numEnvs, 0), 0.0f), m_dones(max(numEnvs, 0), 0),
+  m_terminalObservations(size_t(max(numEnvs, 0)) * OBS_SIZE, 0.0f)
+{
+    for (int i = 0; i < numEnvs; i++)
+        m_envs.push_back(unique_ptr<Env>(new Env));
+    if (numThreads > 1)
+        m_workers.reset(new WorkerGroup(numThreads));
+}
+
+GameEnv::~GameEnv()
+{
+}
+
+bool GameEnv::reset(uint64_t seed, int level) {
+    m_level = level;
+    bool loaded = true;
+    for (int i = 0; i < size(); i++) {
+        if (!startEpisode(i, seed + i))
+            loaded = false;
+        m_rewards[i] = 0.0f;
+        m_dones[i] = 0;
+        observe(i, &m_observations[size_t(i) * OBS_SIZE]);
+    }
+    return loaded;
+}
+
+void GameEnv::step(const int* actions) {
+    if (m_workers != nullptr) {
+        m_workers->run(size(), [this, actions](int begin, int end) { stepRange(begin, end, actions); });
+    }
+    else {
+        stepRange(0, size(), actions);
+    }
+}
+
+// each environment only touches its own world + its own rows of the buffers
+void GameEnv::stepRange(int begin, int end, const int* actions) {
+    for (int i = begin; i < end; i++) {
+        Env& env = *m_envs[i];
+        env.input.setKey(actionKey(actions[i]));
+        env.driver->step();
+
+        unsigned int score = env.driver->getWorld()->getScore();
+        m_rewards[i] = float(score - env.lastScore);
+        env.lastScore = score;
+
+        bool done = env.driver->isDone() || (m_maxEpisodeTicks > 0 && env.driver->getTicks() >= m_maxEpisodeTicks);
+        m_dones[i] = done;
+        if (done) { // keep how the episode ended before the next one replaces it
+            observe(i, &m_terminalObservations[size_t(i) * OBS_SIZE]);
+            startEpisode(i, env.seed + size());
+        }
+        observe(i, &m_observations[size_t(i) * OBS_SIZE]);
+    }
+}
+
+// an environment keeps its world, a new episode restarts it as a new game on the same level
+// worlds only count levels up, so a reset to a different one builds a new world
+bool GameEnv::startEpisode(int env, uint64_t seed) {
+    Env& e = *m_envs[env];
+    e.seed = seed;
+    e.input.setKey(0);
+    
+    int status;
+    if (e.driver != nullptr && (int)e.driver->getWorld()->getLevel() == m_level) {
+        status = e.driver->restart(seed);
+    }
+    else {
+        e.driver.reset(new HeadlessDriver(m_assetPath, m_level, seed, &e.input));
+        status = e.driver->start();
+    }
+    e.lastScore = e.driver->getWorld()->getScore(); // carries on from the last episode
+    return status == GWSTATUS_CONTINUE_GAME;
+}
+
+// writes the view around the avatar + the scalars of env into row
+void GameEnv::observe(int env, float* row) {
+    fill(row, row + OBS_SIZE, 0.0f);
+
+    StudentWorld* world = m_envs[env]->driver->getWorld();
+    const Avatar* avatar = world->getAvatar();
+    if (avatar == nullptr) // the level couldn't be loaded
+        return;
+
+    // centered on the avatar, but never past the edge of a world bigger than the view
+    int avatarX = world->cellX(avatar->getCell());
+    int avatarY = world->cellY(avatar->getCell());
+    int left = max(0, min(avatarX - OBS_WIDTH / 2, world->getWorldWidth() - OBS_WIDTH));
+    int bottom = max(0, min(avatarY - OBS_HEIGHT / 2, world->getWorldHeight() - OBS_HEIGHT));
+
+    for (int y = 0; y < OBS_HEIGHT; y++) {
+        for (int x = 0; x < OBS_WIDTH; x++) {
+            Cell cell = world->cellAt(left + x, bottom + y);
+            if (cell == NO_CELL)
+                continue;
+            const vector<Actor*>& actors = world->actorsAt(cell);
+            for (size_t i = 0; i < actors.size(); i++) {
+                int plane = planeOf(actors[i]);
+                if (plane >= 0 && actors[i]->getStatus() && actors[i]->isVisible())
+                    row[plane * OBS_PLANE_SIZE + y * OBS_WIDTH + x] = 1.0f;
+            }
+        }
+    }
+    row[OBS_PLAYER * OBS_PLANE_SIZE + (avatarY - bottom) * OBS_WIDTH + (avatarX - left)] = 1.0f;
+
+    float* scalars = row + OBS_PLANES * OBS_PLANE_SIZE;
+    scalars[OBS_HEALTH] = avatar->getHealth();
+    scalars[OBS_AMMO_LEFT] = avatar->getAmmo();
+    scalars[OBS_BONUS] = world->getBonus();
+    scalars[OBS_CRYSTALS_LEFT] = world->numCrystals();
+}
@@ -0,0 +1,153 @@
+#ifndef GAMEENV_H_
+#define GAMEENV_H_
+
+#include "HeadlessDriver.h"
+#include "GameConstants.h"
+#include "InputSource.h"
+#include "WorkerGroup.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+using namespace std;
+
+// what an agent can do each step, one key press
+enum EnvAction {
+    ENV_NOOP,
+    ENV_LEFT,
+    ENV_RIGHT,
+    ENV_UP,
+    ENV_DOWN,
+    ENV_FIRE,
+    ENV_NUM_ACTIONS
+};
+
+// one bitplane per kind of thing on the map, 1 where there is a visible one
+enum ObservationPlane {
+    OBS_PLAYER,
+    OBS_WALL,
+    OBS_EXIT, // only once it is revealed
+    OBS_RAGEBOT,
+    OBS_THIEFBOT,
+    OBS_MEAN_THIEFBOT,
+    OBS_FACTORY,
+    OBS_MEAN_FACTORY,
+    OBS_MARBLE,
+    OBS_PIT,
+    OBS_CRYSTAL,
+    OBS_RESTORE_HEALTH,
+    OBS_EXTRA_LIFE, // goodies a thiefbot carries are hidden
+    OBS_AMMO,
+    OBS_PEA,
+    OBS_PLANES
+};
+
+// after the planes, as plain numbers
+enum ObservationScalar {
+    OBS_HEALTH,
+    OBS_AMMO_LEFT,
+    OBS_BONUS,
+    OBS_CRYSTALS_LEFT,
+    OBS_SCALARS
+};
+
+const int OBS_WIDTH = VIEW_WIDTH; // the view around the avatar, all of a view-sized level
+const int OBS_HEIGHT = VIEW_HEIGHT;
+const int OBS_PLANE_SIZE = OBS_WIDTH * OBS_HEIGHT;
+const int OBS_SIZE = OBS_PLANES * OBS_PLANE_SIZE + OBS_SCALARS; // floats per environment
+
+/*
+ A batch of headless worlds stepped together, for training agents.
+
+ Every environment is a HeadlessDriver whose key presses come from the
+ actions passed to step(). It keeps the same world from one episode to the
+ next: a new episode restarts the world from the snapshot it took when the
+ level was built (HeadlessDriver::restart), so resets load nothing and don't
+ reallocate the world. GameWorld can't set the score back, so a world's
+ getScore() keeps counting across episodes, but rewards are per step. Observations, rewards and done flags are written
+ into buffers allocated once, one row per environment, so a caller can wrap
+ the pointers (numpy.frombuffer, torch.from_blob) without copying:
+
+     observations  size() x OBS_SIZE floats, each row OBS_PLANES planes of
+                   OBS_HEIGHT x OBS_WIDTH (row 0 at the bottom) and then
+                   OBS_SCALARS scalars
+     rewards       size() floats, the score gained during the step
+     dones         size() bytes, 1 if the episode ended during the step
+     terminal      size() x OBS_SIZE floats laid out like observations, row i
+     observations  is the last observation of the episode that ended if
+                   dones[i] is 1, and left as it was otherwise
+
+ An episode is a level played until it is finished, the player is out of
+ lives, or the tick limit is reached. An environment that finishes is
+ started again right away on the same level with its next seed (auto-reset),
+ so after a done step its row of observations is already the first one of
+ the new episode. The state the episode ended in, e.g. for bootstrapping a
+ value estimate on a time limit, is in its row of terminalObservations().
+ Environment i plays seeds seed + i, seed + i + size(), ... after
+ reset(seed, level), so a batch replays exactly from the same reset.
+
+ With more than one thread, the environments are split between the threads
+ of a WorkerGroup each step. The worlds share nothing, so the results are
+ the same for any thread count.
+ */
+
+class GameEnv {
+public:
+    GameEnv(string assetPath, int numEnvs, int numThreads = 1);
+    ~GameEnv();
+
+    // starts every environment on level, returns false if the level couldn't be loaded
+    bool reset(uint64_t seed, int level);
+
+    // actions has one EnvAction per environment
+    void step(const int* actions);
+
+    const float* observations() const { return m_observations.data(); }
+    const float* rewards() const { return m_rewards.data(); }
+    const unsigned char* dones() const { return m_dones.data(); }
+    const float* terminalObservations() const { return m_terminalObservations.data(); }
+
+    void setMaxEpisodeTicks(int ticks) { m_maxEpisodeTicks = ticks; } // 0 means no limit
+    int size() const { return m_envs.size(); }
+    int getThreadCount() const { return m_workers != nullptr ? m_workers->getThreadCount() : 1; }
+    StudentWorld* getWorld(int env) { return m_envs[env]->driver->getWorld(); }
+
+private:
+    // hands the avatar the action of the current step, once
+    class ActionInput : public InputSource {
+    public:
+        ActionInput() : m_key(0) {}
+        void setKey(int key) { m_key = key; }
+        virtual bool getKey(int& ch) {
+            ch = m_key;
+            m_key = 0;
+            return ch != 0;
+        }
+
+    private:
+        int m_key;
+    };
+
+    struct Env {
+        unique_ptr<HeadlessDriver> driver;
+        ActionInput input;
+        uint64_t seed; // of the episode being played
+        unsigned int lastScore; // score at the end of the last step, rewards are the difference
+    };
+
+    bool startEpisode(int env, uint64_t seed);
+    void stepRange(int begin, int end, const int* actions);
+    void observe(int env, float* row);
+
+    string m_assetPath;
+    int m_level;
+    int m_maxEpisodeTicks;
+    vector<unique_ptr<Env>> m_envs;
+    unique_ptr<WorkerGroup> m_workers; // nullptr steps every environment on the calling thread
+    vector<float> m_observations;
+    vector<float> m_rewards;
+    vector<unsigned char> m_dones;
+    vector<float> m_terminalObservations; // only rows whose env was done in the last step are current
+};
+
+#endif // GAMEENV_H_
@@ -0,0 +1,80 @@
+#include "HeadlessDriver.h"
+using namespace std;
+
+HeadlessDriver::HeadlessDriver(string assetPath, int level, uint64_t seed, InputSource* input)
+: m_world(new StudentWorld(assetPath)), m_done(false), m_ticks(0), m_status(GWSTATUS_CONTINUE_GAME)
+{
+    m_world->setHeadless(true);
+    m_world->setSeed(seed);
+    m_world->setInputSource(input);
+    
+    // worlds start at level 0
+    for (int i = 0; i < level; i++)
+        m_world->advanceToNextLevel();
+}
+
+HeadlessDriver::~HeadlessDriver()
+{
+    delete m_world;
+}
+
+int HeadlessDriver::start() {
+    m_ticks = 0;
+    m_status = m_world->init();
+    m_done = (m_status != GWSTATUS_CONTINUE_GAME);
+    return m_status;
+}
+
+// full lives + a new seed, then the level is put back from the snapshot init() took when it was
+// first built, so nothing is loaded or reallocated. GameWorld has no way to set the score back,
+// so it keeps counting from where the last game ended
+int HeadlessDriver::restart(uint64_t seed) {
+    while (m_world->getLives() < START_PLAYER_LIVES)
+        m_world->incLives();
+    while (m_world->getLives() > START_PLAYER_LIVES)
+        m_world->decLives();
+    m_world->setSeed(seed);
+    m_world->cleanUp();
+    return start();
+}
+
+int HeadlessDriver::step() {
+    if (m_done)
+        return m_status;
+    
+    m_status = m_world->move();
+    m_ticks++;
+    
+    switch (m_status) {
+        case GWSTATUS_CONTINUE_GAME:
+            break;
+        case GWSTATUS_PLAYER_DIED:
+            // same as the controller: restart the level if there are lives left
+            // on game over the world is left as it ended so it can still be looked at
+            if (m_world->getLives() == 0) {
+                m_done = true;
+                break;
+            }
+            m_world->cleanUp();
+            if (m_world->init() != GWSTATUS_CONTINUE_GAME)
+                m_done = true;
+            break;
+        default: // finished level, won, or error
+            m_done = true;
+            break;
+    }
+    return m_status;
+}
+
+HeadlessResult HeadlessDriver::run(int maxTicks) {
+    start();
+    while (!m_done && m_ticks < maxTicks)
+        step();
+    
+    HeadlessResult result;
+    result.status = m_status;
+    result.ticks = m_ticks;
+    result.score = m_world->getScore();
+    result.lives = m_world->getLives();
+    return result;
+}
@@ -0,0 +1,46 @@
+#ifndef HEADLESSDRIVER_H_
+#define HEADLESSDRIVER_H_
+
+#include "StudentWorld.h"
+#include "InputSource.h"
+#include <string>
+#include <cstdint>
+using namespace std;
+
+// what a headless run ended with
+struct HeadlessResult {
+    int status; // last status from init()/move()
+    int ticks; // number of move() calls
+    unsigned int score;
+    unsigned int lives;
+};
+
+/*
+ Runs one StudentWorld without the GameController: no window, no sound,
+ and key presses come from an InputSource. Deaths restart the level the
+ same way the controller does, and the run stops when the level is
+ finished, the player runs out of lives, or the tick limit is reached.
+ */
+
+class HeadlessDriver {
+public:
+    HeadlessDriver(string assetPath, int level, uint64_t seed, InputSource* input);
+    ~HeadlessDriver();
+    
+    int start(); // loads the level, returns init()'s status
+    int restart(uint64_t seed); // start() over as a new game on the same level, returns init()'s status
+    int step(); // one tick, returns move()'s status
+    HeadlessResult run(int maxTicks); // start() + step() until done
+    
+    bool isDone() const { return m_done; }
+    int getTicks() const { return m_ticks; }
+    StudentWorld* getWorld() { return m_world; }
+    
+private:
+    StudentWorld* m_world;
+    bool m_done;
+    int m_ticks;
+    int m_status;
+};
+
+#endif // HEADLESSDRIVER_H_
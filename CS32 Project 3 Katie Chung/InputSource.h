@@ -0,0 +1,37 @@
+#ifndef INPUTSOURCE_H_
+#define INPUTSOURCE_H_
+
+#include <vector>
+using namespace std;
+
+// where the avatar reads its key presses from when not using the keyboard
+class InputSource {
+public:
+    virtual ~InputSource() {}
+    virtual bool getKey(int& ch) = 0; // called once per tick, false if no key
+};
+
+// plays back a fixed list of keys, one per tick (0 means no key that tick)
+class ScriptedInput : public InputSource {
+public:
+    ScriptedInput(const vector<int>& keys, bool loop = false) : m_keys(keys), m_next(0), m_loop(loop) {}
+
+    virtual bool getKey(int& ch) {
+        if (m_next >= m_keys.size()) {
+            if (!m_loop || m_keys.empty())
+                return false;
+            m_next = 0;
+        }
+        ch = m_keys[m_next++];
+        return ch != 0;
+    }
+
+    void rewind() { m_next = 0; }
+
+private:
+    vector<int> m_keys;
+    size_t m_next;
+    bool m_loop;
+};
+
+#endif // INPUTSOURCE_H_
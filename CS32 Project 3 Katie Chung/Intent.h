@@ -0,0 +1,35 @@
+#ifndef INTENT_H_
+#define INTENT_H_
+
+#include "Cell.h"
+
+/*
+ What a robot or factory has decided to do this tick.
+
+ Their turns are split in two: planIntent only looks at the world and fills
+ in an Intent, and applyIntent carries it out. The normal update does both
+ back to back, so nothing changes. The parallel update (see
+ StudentWorld::setParallelUpdate) plans every robot and factory at once on
+ worker threads, each with its own random generator, then applies the
+ intents one at a time in the usual update order. Moves are checked again
+ when they are applied, so the first robot in that order gets a square two
+ of them wanted.
+ */
+
+enum IntentType {
+    INTENT_NONE,
+    INTENT_SHOOT,
+    INTENT_MOVE, // step into target, facing direction
+    INTENT_TURN, // face direction without moving
+    INTENT_PICK_UP,
+    INTENT_SPAWN
+};
+
+struct Intent {
+    IntentType type;
+    Cell target;
+    int direction;
+    int maxDistance; // thiefbots: new distance before turning, 0 keeps the current one
+};
+
+#endif // INTENT_H_
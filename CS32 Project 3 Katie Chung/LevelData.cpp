@@ -0,0 +1,187 @@
+#include "LevelData.h"
+#include <cstring>
+#include <fstream>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+static const char LEVEL_MAGIC[4] = { 'M', 'M', 'L', 'V' };
+
+// checks the header + that the file is big enough for its grid
+static bool validHeader(const LevelHeader& header, size_t fileSize) {
+    if (memcmp(header.magic, LEVEL_MAGIC, 4) != 0 || header.version != LEVEL_FILE_VERSION)
+        return false;
+    if (header.width == 0 || header.height == 0 || header.width > MAX_LEVEL_SIZE || header.height > MAX_LEVEL_SIZE)
+        return false;
+    return fileSize >= sizeof(LevelHeader) + (size_t)header.width * header.height;
+}
+
+// counts what's in a grid + checks it's a level the world can play, the same way Level::loadLevel does:
+// every byte a MazeEntry, exactly one player, and walls all the way around the edge
+static bool countCells(const unsigned char* cells, int width, int height, uint32_t counts[NUM_MAZE_ENTRIES]) {
+    memset(counts, 0, sizeof(uint32_t) * NUM_MAZE_ENTRIES);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            unsigned char entry = cells[(size_t)y * width + x];
+            if (entry >= NUM_MAZE_ENTRIES)
+                return false;
+            bool edge = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+            if (edge && entry != Level::wall)
+                return false;
+            counts[entry]++;
+        }
+    }
+    return counts[Level::player] == 1;
+}
+
+LevelData::LevelData()
+: m_cells(nullptr), m_map(nullptr), m_mapSize(0)
+{
+    clear();
+}
+
+LevelData::~LevelData()
+{
+    unmap();
+}
+
+void LevelData::clear() {
+    unmap();
+    memset(&m_header, 0, sizeof(m_header));
+    m_owned.clear();
+    m_cells = nullptr;
+}
+
+void LevelData::unmap() {
+#ifndef _WIN32
+    if (m_map != nullptr)
+        munmap(m_map, m_mapSize);
+#endif
+    m_map = nullptr;
+    m_mapSize = 0;
+}
+
+// parses a text level through Level + counts what's in it
+Level::LoadResult LevelData::loadText(string assetDir, string fileName) {
+    clear();
+    
+    Level lev(assetDir);
+    Level::LoadResult result = lev.loadLevel(fileName);
+    if (result != Level::load_success)
+        return result;
+    
+    memcpy(m_header.magic, LEVEL_MAGIC, 4);
+    m_header.version = LEVEL_FILE_VERSION;
+    m_header.width = VIEW_WIDTH;
+    m_header.height = VIEW_HEIGHT;
+    
+    m_owned.resize(VIEW_WIDTH * VIEW_HEIGHT);
+    for (int y = 0; y < VIEW_HEIGHT; y++) {
+        for (int x = 0; x < VIEW_WIDTH; x++) {
+            Level::MazeEntry entry = lev.getContentsOf(x, y);
+            m_owned[y * VIEW_WIDTH + x] = entry;
+            m_header.counts[entry]++;
+        }
+    }
+    m_header.crystals = m_header.counts[Level::crystal];
+    m_cells = m_owned.data();
+    return Level::load_success;
+}
+
+// copies a grid built in memory + counts what's in it, checked like a compiled level
+Level::LoadResult LevelData::loadCells(int width, int height, const vector<unsigned char>& cells) {
+    clear();
+    if (width <= 0 || height <= 0 || width > MAX_LEVEL_SIZE || height > MAX_LEVEL_SIZE ||
+        cells.size() != (size_t)width * height)
+        return Level::load_fail_bad_format;
+    
+    memcpy(m_header.magic, LEVEL_MAGIC, 4);
+    m_header.version = LEVEL_FILE_VERSION;
+    m_header.width = width;
+    m_header.height = height;
+    
+    if (!countCells(cells.data(), width, height, m_header.counts)) {
+        clear();
+        return Level::load_fail_bad_format;
+    }
+    m_header.crystals = m_header.counts[Level::crystal];
+    m_owned = cells;
+    m_cells = m_owned.data();
+    return Level::load_success;
+}
+
+// maps a compiled level straight into memory
+Level::LoadResult LevelData::loadCompiled(string path) {
+    clear();
+    
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return Level::load_fail_file_not_found;
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(LevelHeader)) {
+        close(fd);
+        return Level::load_fail_bad_format;
+    }
+    
+    void* map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping stays valid after the file is closed
+    if (map == MAP_FAILED)
+        return Level::load_fail_file_not_found;
+    
+    m_map = map;
+    m_mapSize = info.st_size;
+    memcpy(&m_header, map, sizeof(LevelHeader));
+    if (!validHeader(m_header, m_mapSize)) {
+        clear();
+        return Level::load_fail_bad_format;
+    }
+    m_cells = static_cast<const unsigned char*>(map) + sizeof(LevelHeader);
+#else
+    // no mmap here, read the whole file in one go instead
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in)
+        return Level::load_fail_file_not_found;
+    
+    size_t size = in.tellg();
+    in.seekg(0);
+    if (size < sizeof(LevelHeader) || !in.read(reinterpret_cast<char*>(&m_header), sizeof(LevelHeader)) ||
+        !validHeader(m_header, size)) {
+        clear();
+        return Level::load_fail_bad_format;
+    }
+    
+    m_owned.resize((size_t)m_header.width * m_header.height);
+    if (!in.read(reinterpret_cast<char*>(m_owned.data()), m_owned.size())) {
+        clear();
+        return Level::load_fail_bad_format;
+    }
+    m_cells = m_owned.data();
+#endif
+    
+    // the world sizes its pools from the header, so it has to agree with the grid
+    uint32_t counts[NUM_MAZE_ENTRIES];
+    if (!countCells(m_cells, m_header.width, m_header.height, counts) ||
+        memcmp(counts, m_header.counts, sizeof(counts)) != 0 || m_header.crystals != counts[Level::crystal]) {
+        clear();
+        return Level::load_fail_bad_format;
+    }
+    return Level::load_success;
+}
+
+bool LevelData::saveCompiled(string path) const {
+    if (!isLoaded())
+        return false;
+    
+    ofstream out(path, ios::binary);
+    if (!out)
+        return false;
+    out.write(reinterpret_cast<const char*>(&m_header), sizeof(LevelHeader));
+    out.write(reinterpret_cast<const char*>(m_cells), (size_t)m_header.width * m_header.height);
+    return bool(out);
+}
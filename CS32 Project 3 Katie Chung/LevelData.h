@@ -0,0 +1,73 @@
+#ifndef LEVELDATA_H_
+#define LEVELDATA_H_
+
+#include "Level.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+const int NUM_MAZE_ENTRIES = Level::ammo + 1; // ammo is the last MazeEntry
+const uint16_t LEVEL_FILE_VERSION = 2; // 2: 32-bit counts for maps bigger than the view
+const int MAX_LEVEL_SIZE = 32767; // snapshots keep positions in 16 bits
+
+// start of a compiled .bin level, followed by width * height MazeEntry bytes (row by row from y = 0)
+struct LevelHeader {
+    char magic[4]; // "MMLV"
+    uint16_t version;
+    uint16_t width;
+    uint16_t height;
+    uint16_t reserved;
+    uint32_t crystals;
+    uint32_t counts[NUM_MAZE_ENTRIES]; // how many cells hold each MazeEntry
+};
+
+/*
+ The maze a StudentWorld is built from.
+
+ It can come from a levelNN.txt file (parsed through Level, so always the
+ size of the view), from a compiled levelNN.bin file of any size, which is
+ memory mapped and read in place with no parsing, or from cells built in
+ memory (see MazeGenerator.h). Either way the world sees a width x height grid of MazeEntry
+ values plus the number of cells holding each entry, so it can size its
+ actor pools before constructing anything.
+
+ Compiled levels and cells built in memory are checked the way Level checks
+ a text one (exactly one player, walls all the way around), and a compiled
+ level's header counts have to match its grid, since the world trusts both.
+ */
+
+class LevelData {
+public:
+    LevelData();
+    ~LevelData();
+    
+    Level::LoadResult loadText(string assetDir, string fileName);
+    Level::LoadResult loadCompiled(string path);
+    Level::LoadResult loadCells(int width, int height, const vector<unsigned char>& cells); // e.g. a generated Maze
+    bool saveCompiled(string path) const;
+    void clear();
+    
+    bool isLoaded() const { return m_cells != nullptr; }
+    int getWidth() const { return m_header.width; }
+    int getHeight() const { return m_header.height; }
+    int getCrystals() const { return m_header.crystals; }
+    int getCount(Level::MazeEntry entry) const { return m_header.counts[entry]; }
+    Level::MazeEntry getContentsOf(int x, int y) const {
+        return Level::MazeEntry(m_cells[y * m_header.width + x]);
+    }
+    
+private:
+    LevelData(const LevelData&);
+    LevelData& operator=(const LevelData&);
+    
+    void unmap();
+    
+    LevelHeader m_header;
+    vector<unsigned char> m_owned; // cells parsed from text or read without mmap
+    const unsigned char* m_cells; // points into m_owned or the mapping
+    void* m_map;
+    size_t m_mapSize;
+};
+
+#endif // LEVELDATA_H_
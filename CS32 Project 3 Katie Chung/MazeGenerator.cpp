@@ -0,0 +1,171 @@
+#include "MazeGenerator.h"
+#include "DistanceField.h"
+#include "Random.h"
+#include <fstream>
+#include <algorithm>
+using namespace std;
+
+char mazeEntryChar(Level::MazeEntry entry) {
+    switch (entry) {
+        case Level::empty:
+            return ' ';
+        case Level::exit:
+            return 'x';
+        case Level::player:
+            return '@';
+        case Level::horiz_ragebot:
+            return 'h';
+        case Level::vert_ragebot:
+            return 'v';
+        case Level::thiefbot_factory:
+            return '1';
+        case Level::mean_thiefbot_factory:
+            return '2';
+        case Level::wall:
+            return '#';
+        case Level::marble:
+            return 'b';
+        case Level::pit:
+            return 'o';
+        case Level::crystal:
+            return '*';
+        case Level::restore_health:
+            return 'r';
+        case Level::extra_life:
+            return 'e';
+        case Level::ammo:
+            return 'a';
+    }
+    return ' ';
+}
+
+// every open square the player can walk to from start, walls are the only thing in the way yet
+static vector<int> reachableFrom(const Maze& maze, int start) {
+    vector<bool> seen(maze.cells.size(), false);
+    vector<int> reached;
+    reached.push_back(start);
+    seen[start] = true;
+
+    for (size_t i = 0; i < reached.size(); i++) {
+        int x = reached[i] % maze.width;
+        int y = reached[i] / maze.width;
+        int next[4] = { reached[i] - 1, reached[i] + 1, reached[i] - maze.width, reached[i] + maze.width };
+        bool inside[4] = { x > 0, x < maze.width - 1, y > 0, y < maze.height - 1 };
+        for (int d = 0; d < 4; d++) {
+            if (inside[d] && !seen[next[d]] && maze.cells[next[d]] != Level::wall) {
+                seen[next[d]] = true;
+                reached.push_back(next[d]);
+            }
+        }
+    }
+    return reached;
+}
+
+// marks a shortest path from every goal back to the player, who is the target of field
+static void markPaths(const Maze& maze, const DistanceField& field, const vector<int>& goals, vector<bool>& onPath) {
+    static const int offsetX[4] = { -1, 1, 0, 0 };
+    static const int offsetY[4] = { 0, 0, -1, 1 };
+    for (size_t g = 0; g < goals.size(); g++) {
+        int x = goals[g] % maze.width;
+        int y = goals[g] / maze.width;
+        onPath[goals[g]] = true;
+        for (int d = field.distance(x, y); d > 0 && d != NO_DISTANCE; d--) {
+            int next = 0;
+            while (field.distance(x + offsetX[next], y + offsetY[next]) != d - 1)
+                next++;
+            x += offsetX[next];
+            y += offsetY[next];
+            onPath[y * maze.width + x] = true;
+        }
+    }
+}
+
+Maze generateMaze(const MazeParams& params) {
+    RandomGenerator rng(params.seed);
+    Maze maze;
+    maze.width = max(params.width, 3);
+    maze.height = max(params.height, 3);
+    maze.cells.assign(maze.width * maze.height, Level::empty);
+
+    // border walls, then random walls inside
+    uint32_t wallChance = uint32_t(min(max(params.wallDensity, 0.0), 1.0) * 4294967295.0);
+    vector<int> open;
+    for (int y = 0; y < maze.height; y++) {
+        for (int x = 0; x < maze.width; x++) {
+            int i = y * maze.width + x;
+            if (x == 0 || y == 0 || x == maze.width - 1 || y == maze.height - 1 || rng.next() < wallChance)
+                maze.cells[i] = Level::wall;
+            else
+                open.push_back(i);
+        }
+    }
+
+    // a maze that came out solid still gets a square for the player
+    if (open.empty()) {
+        int center = (maze.height / 2) * maze.width + maze.width / 2;
+        maze.cells[center] = Level::empty;
+        open.push_back(center);
+    }
+    int start = open[rng.randInt(0, open.size() - 1)];
+    maze.cells[start] = Level::player;
+
+    // everything else is dealt out in a random order over the squares the player can reach
+    vector<int> squares = reachableFrom(maze, start);
+    squares.erase(squares.begin()); // the player's own square
+    size_t used = 0;
+    vector<int> placed;
+    auto place = [&](Level::MazeEntry entry, int count) {
+        placed.clear();
+        for (int n = 0; n < count && used < squares.size(); n++, used++) {
+            size_t pick = used + rng.randInt(0, squares.size() - used - 1);
+            swap(squares[used], squares[pick]);
+            maze.cells[squares[used]] = entry;
+            placed.push_back(squares[used]);
+        }
+    };
+
+    place(Level::exit, 1);
+    vector<int> goals = placed;
+    place(Level::crystal, params.crystals);
+    goals.insert(goals.end(), placed.begin(), placed.end());
+
+    // factories, marbles and pits stop the player, so they stay off a shortest path to every goal
+    DistanceField field;
+    field.build(0, 0, maze.width, maze.height, vector<pair<int, int>>(1, make_pair(start % maze.width, start / maze.width)), 0,
+                [&maze](int x, int y) { return maze.at(x, y) == Level::wall; });
+    vector<bool> onPath(maze.cells.size(), false);
+    markPaths(maze, field, goals, onPath);
+    auto offPath = stable_partition(squares.begin() + used, squares.end(), [&onPath](int square) { return !onPath[square]; });
+    vector<int> pathSquares(offPath, squares.end()); // held back until the obstacles are down
+    squares.erase(offPath, squares.end());
+
+    place(Level::thiefbot_factory, params.factories);
+    place(Level::mean_thiefbot_factory, params.meanFactories);
+    place(Level::marble, params.marbles);
+    place(Level::pit, params.pits);
+    squares.insert(squares.end(), pathSquares.begin(), pathSquares.end());
+
+    // robots + goodies can go anywhere, the player can walk over goodies and shoot robots
+    place(Level::horiz_ragebot, (params.rageBots + 1) / 2);
+    place(Level::vert_ragebot, params.rageBots / 2);
+    for (int g = 0; g < params.goodies; g++) {
+        static const Level::MazeEntry goodies[3] = { Level::extra_life, Level::restore_health, Level::ammo };
+        place(goodies[g % 3], 1);
+    }
+    return maze;
+}
+
+// top row first, the way levelNN.txt files are laid out
+bool saveMazeText(const string& path, const Maze& maze) {
+    ofstream out(path);
+    if (!out)
+        return false;
+
+    for (int y = maze.height - 1; y >= 0; y--) {
+        string row;
+        for (int x = 0; x < maze.width; x++)
+            row += mazeEntryChar(maze.at(x, y));
+        out << row << '\n';
+    }
+    return bool(out);
+}
@@ -0,0 +1,54 @@
+#ifndef MAZEGENERATOR_H_
+#define MAZEGENERATOR_H_
+
+#include "Level.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+// what to put in a generated maze, counts are cut down if there isn't room
+struct MazeParams {
+    int width = VIEW_WIDTH;
+    int height = VIEW_HEIGHT;
+    double wallDensity = 0.2; // chance each inside square starts as a wall
+    int crystals = 3;
+    int factories = 1; // regular thiefbot factories
+    int meanFactories = 1;
+    int rageBots = 2; // horizontal or vertical, half each
+    int marbles = 2;
+    int pits = 2;
+    int goodies = 3; // extra life, restore health and ammo in turn
+    uint64_t seed = 1;
+};
+
+// a maze as MazeEntry values, row by row from y = 0 like a compiled level
+struct Maze {
+    int width;
+    int height;
+    vector<unsigned char> cells;
+
+    Level::MazeEntry at(int x, int y) const { return Level::MazeEntry(cells[y * width + x]); }
+};
+
+/*
+ Generates random mazes for stress tests and benchmarks.
+
+ The outside edge is all wall and the inside is scattered with walls at the
+ given density. The player goes on a random open square, and everything else
+ (the exit included) only goes on squares the player can walk to. Factories,
+ marbles and pits are kept off one shortest path (a DistanceField from the
+ player) to the exit and to each crystal, so none of them ever has to be
+ cleared and the level can always be finished if the robots allow it. The
+ same params and seed always give the same maze.
+
+ A maze can be saved in the levelNN.txt format, compiled to a levelNN.bin
+ through LevelData, or handed straight to a StudentWorld with setMaze().
+ Only view-sized text levels can be read back by Level.
+ */
+
+Maze generateMaze(const MazeParams& params);
+bool saveMazeText(const string& path, const Maze& maze);
+char mazeEntryChar(Level::MazeEntry entry); // the character levelNN.txt uses for it
+
+#endif // MAZEGENERATOR_H_
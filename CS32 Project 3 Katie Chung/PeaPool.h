@@ -0,0 +1,175 @@
+#ifndef PEAPOOL_H_
+#define PEAPOOL_H_
+
+#include "Actor.h"
+#include "ActorPool.h"
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+using namespace std;
+
+class StudentWorld;
+
+const int PEA_POOL_CAPACITY = 128; // peas constructed up front by reserve()
+
+/*
+ Recycles Pea objects instead of constructing and destroying one per shot.
+
+ Every pea ever made stays constructed in the underlying ActorPool. A dead
+ pea is hidden and put on the free list, and the next shot resets it in
+ place, so firing and removing peas costs no heap allocation once the pool
+ is big enough. If more peas are in flight than the pool holds, it grows by
+ one pea and the high-water mark shows how big it needs to be.
+
+ What the world needs to move the peas each tick is also kept here as one
+ array per field (PeaLanes), indexed in firing order like the peas in play,
+ so the next square of every pea can be worked out in one pass.
+ */
+
+// the peas in play, a field at a time, index i is the i-th pea fired
+struct PeaLanes {
+    vector<int> x; // square the pea is on
+    vector<int> y;
+    vector<int> dx; // one step in the direction it flies
+    vector<int> dy;
+    vector<unsigned char> alive;
+};
+
+class PeaPool {
+public:
+    PeaPool() : m_world(nullptr), m_highWater(0) {}
+
+    // constructs capacity hidden peas so firing never allocates
+    void reserve(StudentWorld* world, int capacity) {
+        m_world = world;
+        m_active.reserve(capacity);
+        m_lanes.x.reserve(capacity);
+        m_lanes.y.reserve(capacity);
+        m_lanes.dx.reserve(capacity);
+        m_lanes.dy.reserve(capacity);
+        m_lanes.alive.reserve(capacity);
+        m_free.reserve(capacity);
+        while (m_storage.size() < capacity)
+            m_free.push_back(makeHiddenPea());
+    }
+
+    // takes a pea off the free list + puts it in play on cell, which is square (x, y)
+    Pea* fire(Cell cell, int x, int y, int direction) {
+        if (m_free.empty())
+            m_free.push_back(makeHiddenPea());
+        Pea* pea = m_free.back();
+        m_free.pop_back();
+
+        pea->reset(cell, direction);
+        m_active.push_back(pea);
+        m_lanes.x.push_back(x);
+        m_lanes.y.push_back(y);
+        m_lanes.dx.push_back(direction == GraphObject::right ? 1 : direction == GraphObject::left ? -1 : 0);
+        m_lanes.dy.push_back(direction == GraphObject::up ? 1 : direction == GraphObject::down ? -1 : 0);
+        m_lanes.alive.push_back(true);
+        if ((int)m_active.size() > m_highWater)
+            m_highWater = m_active.size();
+        return pea;
+    }
+
+    // calls func on every pea in play in the order they were fired, stops early if func returns false
+    template <typename F>
+    bool forEach(F func) {
+        for (size_t i = 0; i < m_active.size(); i++) {
+            if (!func(m_active[i]))
+                return false;
+        }
+        return true;
+    }
+
+    // works out the square each pea in play moves to next, four at a time with SSE2
+    void step(vector<int>& nextX, vector<int>& nextY) const {
+        size_t count = m_active.size();
+        nextX.resize(count);
+        nextY.resize(count);
+        size_t i = 0;
+#ifdef __SSE2__
+        for (; i + 4 <= count; i += 4) {
+            __m128i x = _mm_loadu_si128((const __m128i*)&m_lanes.x[i]);
+            __m128i y = _mm_loadu_si128((const __m128i*)&m_lanes.y[i]);
+            __m128i dx = _mm_loadu_si128((const __m128i*)&m_lanes.dx[i]);
+            __m128i dy = _mm_loadu_si128((const __m128i*)&m_lanes.dy[i]);
+            _mm_storeu_si128((__m128i*)&nextX[i], _mm_add_epi32(x, dx));
+            _mm_storeu_si128((__m128i*)&nextY[i], _mm_add_epi32(y, dy));
+        }
+#endif
+        for (; i < count; i++) { // what's left over, or everything without SSE2
+            nextX[i] = m_lanes.x[i] + m_lanes.dx[i];
+            nextY[i] = m_lanes.y[i] + m_lanes.dy[i];
+        }
+    }
+
+    // moves dead peas back to the free list, keeping the rest in firing order
+    void removeDead() {
+        size_t kept = 0;
+        for (size_t i = 0; i < m_active.size(); i++) {
+            Pea* pea = m_active[i];
+            if (pea->getStatus()) {
+                m_active[kept] = pea;
+                m_lanes.x[kept] = m_lanes.x[i];
+                m_lanes.y[kept] = m_lanes.y[i];
+                m_lanes.dx[kept] = m_lanes.dx[i];
+                m_lanes.dy[kept] = m_lanes.dy[i];
+                m_lanes.alive[kept] = true;
+                kept++;
+            }
+            else {
+                retire(pea);
+            }
+        }
+        m_active.resize(kept);
+        resizeLanes(kept);
+    }
+
+    // hides every pea in play, keeping them constructed for the next level
+    void clear() {
+        for (size_t i = 0; i < m_active.size(); i++)
+            retire(m_active[i]);
+        m_active.clear();
+        resizeLanes(0);
+    }
+
+    // the i-th pea in play, its lanes are at index i
+    Pea* at(int i) const { return m_active[i]; }
+    PeaLanes& lanes() { return m_lanes; }
+
+    int size() const { return m_active.size(); }
+    int capacity() const { return m_storage.size(); }
+    int highWaterMark() const { return m_highWater; }
+
+private:
+    Pea* makeHiddenPea() {
+        int direction = GraphObject::right;
+        Pea* pea = m_storage.create(m_world, 0.0, 0.0, direction);
+        pea->retire();
+        return pea;
+    }
+
+    void retire(Pea* pea) {
+        pea->retire();
+        m_free.push_back(pea);
+    }
+
+    void resizeLanes(size_t count) {
+        m_lanes.x.resize(count);
+        m_lanes.y.resize(count);
+        m_lanes.dx.resize(count);
+        m_lanes.dy.resize(count);
+        m_lanes.alive.resize(count);
+    }
+
+    StudentWorld* m_world;
+    ActorPool<Pea> m_storage; // every pea, in play or not
+    vector<Pea*> m_active; // peas in play
+    PeaLanes m_lanes; // what moving them needs, in the same order
+    vector<Pea*> m_free; // hidden peas ready to be fired
+    int m_highWater; // most peas ever in play at once
+};
+
+#endif // PEAPOOL_H_
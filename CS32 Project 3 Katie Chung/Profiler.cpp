@@ -0,0 +1,146 @@
+#include "Profiler.h"
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <memory>
+using namespace std;
+
+const size_t MAX_TRACE_EVENTS = 1 << 20; // per thread, stats keep counting past this
+
+static const char* QUERY_NAMES[NUM_PROFILE_QUERIES] = {
+    "getActorAtPos",
+    "isInBounds",
+    "canMarbleMove",
+    "overlapPea",
+    "canRobotMove",
+    "robotCanShootPlayer",
+    "onSameSquareAsGoodie",
+    "onSameSquareAsThiefBot",
+    "countSurroundingThiefBots"
+};
+
+// every thread's profiler, they live until the program ends so threads can finish first
+static mutex& registryLock() {
+    static mutex m;
+    return m;
+}
+static vector<unique_ptr<Profiler>>& registry() {
+    static vector<unique_ptr<Profiler>> profilers;
+    return profilers;
+}
+
+Profiler& Profiler::get() {
+    thread_local Profiler* mine = nullptr;
+    if (mine == nullptr) {
+        lock_guard<mutex> guard(registryLock());
+        mine = new Profiler;
+        mine->m_threadIndex = registry().size();
+        registry().push_back(unique_ptr<Profiler>(mine));
+    }
+    return *mine;
+}
+
+Profiler::Profiler()
+: m_threadIndex(0)
+{
+    clear();
+}
+
+long long Profiler::now() {
+    static const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+}
+
+void Profiler::addScope(const char* name, long long startNs, long long durationNs) {
+    // names are literals, so the same scope always passes the same pointer
+    size_t i = 0;
+    while (i < m_scopes.size() && m_scopes[i].name != name)
+        i++;
+    if (i == m_scopes.size())
+        m_scopes.push_back(ScopeStats { name, 0, 0 });
+    m_scopes[i].calls++;
+    m_scopes[i].totalNs += durationNs;
+
+    if (m_events.size() < MAX_TRACE_EVENTS)
+        m_events.push_back(TraceEvent { name, startNs, durationNs });
+}
+
+void Profiler::clear() {
+    m_scopes.clear();
+    m_events.clear();
+    for (int i = 0; i < NUM_PROFILE_QUERIES; i++) {
+        m_queryCalls[i] = 0;
+        m_queryScanned[i] = 0;
+    }
+}
+
+void Profiler::reset() {
+    lock_guard<mutex> guard(registryLock());
+    for (size_t i = 0; i < registry().size(); i++)
+        registry()[i]->clear();
+}
+
+// one line per scope (time) and per query (calls + actors looked at), summed over threads
+bool Profiler::writeCsv(const string& path) {
+    FILE* out = fopen(path.c_str(), "w");
+    if (out == nullptr)
+        return false;
+
+    lock_guard<mutex> guard(registryLock());
+    vector<unique_ptr<Profiler>>& profilers = registry();
+
+    // the same literal can have different addresses in different files, so merge by text
+    vector<ScopeStats> scopes;
+    for (size_t p = 0; p < profilers.size(); p++) {
+        for (const ScopeStats& s : profilers[p]->m_scopes) {
+            size_t i = 0;
+            while (i < scopes.size() && strcmp(scopes[i].name, s.name) != 0)
+                i++;
+            if (i == scopes.size())
+                scopes.push_back(ScopeStats { s.name, 0, 0 });
+            scopes[i].calls += s.calls;
+            scopes[i].totalNs += s.totalNs;
+        }
+    }
+
+    fprintf(out, "kind,name,calls,total_ns,ns_per_call,actors_scanned\n");
+    for (const ScopeStats& s : scopes)
+        fprintf(out, "scope,%s,%lld,%lld,%.1f,\n", s.name, s.calls, s.totalNs, s.calls ? double(s.totalNs) / s.calls : 0.0);
+
+    for (int q = 0; q < NUM_PROFILE_QUERIES; q++) {
+        long long calls = 0;
+        long long scanned = 0;
+        for (size_t p = 0; p < profilers.size(); p++) {
+            calls += profilers[p]->m_queryCalls[q];
+            scanned += profilers[p]->m_queryScanned[q];
+        }
+        fprintf(out, "query,%s,%lld,,,%lld\n", QUERY_NAMES[q], calls, scanned);
+    }
+
+    fclose(out);
+    return true;
+}
+
+// complete ("X") events in microseconds, one track per thread
+bool Profiler::writeChromeTrace(const string& path) {
+    FILE* out = fopen(path.c_str(), "w");
+    if (out == nullptr)
+        return false;
+
+    lock_guard<mutex> guard(registryLock());
+    vector<unique_ptr<Profiler>>& profilers = registry();
+
+    fprintf(out, "{\"traceEvents\":[\n");
+    bool first = true;
+    for (size_t p = 0; p < profilers.size(); p++) {
+        for (const TraceEvent& e : profilers[p]->m_events) {
+            fprintf(out, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    first ? "" : ",\n", e.name, profilers[p]->m_threadIndex, e.startNs / 1000.0, e.durationNs / 1000.0);
+            first = false;
+        }
+    }
+    fprintf(out, "\n]}\n");
+
+    fclose(out);
+    return true;
+}
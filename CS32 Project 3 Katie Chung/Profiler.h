@@ -0,0 +1,99 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <string>
+#include <vector>
+#include <chrono>
+using namespace std;
+
+/*
+ Tick profiler, only compiled in when MM_PROFILE is defined (-DMM_PROFILE).
+
+ PROFILE_SCOPE times a block (move() uses it for the whole tick and for each
+ actor type's doSomething calls). PROFILE_QUERY counts a call to a world
+ query and goes on its first line, so calls answered early (the avatar's
+ square, off the map, an empty square) count too. PROFILE_SCANNED adds how
+ many actors were in the square the query then looked through. Without
+ MM_PROFILE the macros expand to nothing.
+
+ Each thread records into its own Profiler, so worlds running in a
+ BatchRunner or a WorkerGroup don't contend. writeCsv and writeChromeTrace
+ add up every thread's numbers; call them (and reset) only while no world is
+ running. The trace can be opened in chrome://tracing or Perfetto.
+ */
+
+enum ProfileQuery {
+    QUERY_GET_ACTOR_AT_POS,
+    QUERY_IS_IN_BOUNDS,
+    QUERY_CAN_MARBLE_MOVE,
+    QUERY_OVERLAP_PEA,
+    QUERY_CAN_ROBOT_MOVE,
+    QUERY_ROBOT_CAN_SHOOT_PLAYER,
+    QUERY_ON_SAME_SQUARE_AS_GOODIE,
+    QUERY_ON_SAME_SQUARE_AS_THIEFBOT,
+    QUERY_COUNT_SURROUNDING_THIEFBOTS,
+    NUM_PROFILE_QUERIES
+};
+
+class Profiler {
+public:
+    static Profiler& get(); // the calling thread's profiler
+
+    void addScope(const char* name, long long startNs, long long durationNs);
+    void countQuery(ProfileQuery query) { m_queryCalls[query]++; }
+    void countScanned(ProfileQuery query, int scanned) { m_queryScanned[query] += scanned; }
+
+    static long long now(); // ns since the profiler started
+
+    // every thread's numbers
+    static void reset();
+    static bool writeCsv(const string& path);
+    static bool writeChromeTrace(const string& path);
+
+private:
+    Profiler();
+
+    struct ScopeStats {
+        const char* name;
+        long long calls;
+        long long totalNs;
+    };
+    struct TraceEvent {
+        const char* name;
+        long long startNs;
+        long long durationNs;
+    };
+
+    void clear();
+
+    int m_threadIndex;
+    vector<ScopeStats> m_scopes;
+    vector<TraceEvent> m_events;
+    long long m_queryCalls[NUM_PROFILE_QUERIES];
+    long long m_queryScanned[NUM_PROFILE_QUERIES];
+};
+
+// times the rest of the enclosing block
+class ProfileScope {
+public:
+    ProfileScope(const char* name) : m_name(name), m_start(Profiler::now()) {}
+    ~ProfileScope() { Profiler::get().addScope(m_name, m_start, Profiler::now() - m_start); }
+
+private:
+    const char* m_name; // has to be a string literal
+    long long m_start;
+};
+
+#ifdef MM_PROFILE
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_QUERY(query) Profiler::get().countQuery(query)
+#define PROFILE_SCANNED(query, scanned) Profiler::get().countScanned(query, scanned)
+#else
+#define PROFILE_SCOPE(name) ((void)(name))
+#define PROFILE_QUERY(query) ((void)0)
+#define PROFILE_SCANNED(query, scanned) ((void)0)
+#endif
+
+#endif // PROFILER_H_
@@ -0,0 +1,45 @@
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <cstdint>
+
+/*
+ Small seedable random number generator (PCG32).
+
+ Each StudentWorld owns one so a level plays out the same way every time it
+ is run with the same seed, and so several worlds can run side by side
+ without sharing the global rand() state.
+ */
+
+class RandomGenerator {
+public:
+    RandomGenerator(uint64_t seed = 0) { setSeed(seed); }
+
+    void setSeed(uint64_t seed) {
+        m_state = 0;
+        m_inc = (seed << 1) | 1;
+        next();
+        m_state += seed;
+        next();
+    }
+
+    uint32_t next() {
+        uint64_t old = m_state;
+        m_state = old * 6364136223846793005ULL + m_inc;
+        uint32_t shifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rot = (uint32_t)(old >> 59);
+        return (shifted >> rot) | (shifted << ((32 - rot) & 31));
+    }
+
+    // random int between min and max inclusive
+    int randInt(int min, int max) {
+        uint64_t range = (uint64_t)(max - min) + 1;
+        return min + (int)((next() * range) >> 32);
+    }
+
+private:
+    uint64_t m_state;
+    uint64_t m_inc;
+};
+
+#endif // RANDOM_H_
@@ -0,0 +1,142 @@
+#include "Replay.h"
+#include "HeadlessDriver.h"
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+using namespace std;
+
+// 7 bits per byte, high bit set on every byte but the last
+static void writeVarint(ofstream& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.put(char((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.put(char(value));
+}
+
+static bool readVarint(ifstream& in, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == EOF)
+            return false;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+bool saveReplay(const string& path, const Replay& replay) {
+    ofstream out(path, ios::binary);
+    if (!out)
+        return false;
+
+    ReplayHeader header = replay.header;
+    memcpy(header.magic, "MMRP", 4);
+    header.version = REPLAY_FILE_VERSION;
+    header.runCount = replay.runs.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(ReplayHeader));
+
+    // keys are stored shifted by one so no key (0) and negative keys both stay small
+    for (const KeyRun& run : replay.runs) {
+        writeVarint(out, uint32_t(run.key + 1));
+        writeVarint(out, run.length);
+    }
+    return bool(out);
+}
+
+bool loadReplay(const string& path, Replay& replay) {
+    ifstream in(path, ios::binary);
+    if (!in)
+        return false;
+
+    ReplayHeader& header = replay.header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(ReplayHeader)))
+        return false;
+    if (memcmp(header.magic, "MMRP", 4) != 0 || header.version < 1 || header.version > REPLAY_FILE_VERSION)
+        return false;
+    if (header.version == 1) // flags were padding then
+        header.flags = 0;
+
+    replay.runs.clear();
+    replay.runs.reserve(header.runCount);
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < header.runCount; i++) {
+        uint64_t key, length;
+        if (!readVarint(in, key) || !readVarint(in, length) || length == 0)
+            return false;
+        replay.runs.push_back(KeyRun { int(uint32_t(key) - 1), uint32_t(length) });
+        total += length;
+    }
+    return total == (uint64_t)header.ticks;
+}
+
+/* ///////////////// RECORDER /////////////////*/
+
+void ReplayRecorder::beginLevel(int level, uint64_t seed, unsigned int score, int lives, uint32_t flags) {
+    m_replay.header = ReplayHeader();
+    m_replay.header.level = level;
+    m_replay.header.seed = seed;
+    m_replay.header.startLives = lives;
+    m_replay.header.flags = flags;
+    m_replay.runs.clear();
+    m_startScore = score;
+    m_recording = true;
+}
+
+void ReplayRecorder::recordKey(int key) {
+    if (!m_recording)
+        return;
+
+    m_replay.header.ticks++;
+    if (!m_replay.runs.empty() && m_replay.runs.back().key == key)
+        m_replay.runs.back().length++;
+    else
+        m_replay.runs.push_back(KeyRun { key, 1 });
+}
+
+bool ReplayRecorder::endLevel(unsigned int score, int lives, uint64_t stateHash) {
+    if (!m_recording)
+        return false;
+    m_recording = false;
+
+    m_replay.header.scoreGained = score - m_startScore;
+    m_replay.header.endLives = lives;
+    m_replay.header.stateHash = stateHash;
+
+    char name[64];
+    snprintf(name, sizeof(name), "replay_level%02d_%llu.mmr", m_replay.header.level, (unsigned long long)m_replay.header.seed);
+    m_lastPath = m_directory + "/" + name;
+    return saveReplay(m_lastPath, m_replay);
+}
+
+/* ///////////////// PLAYBACK /////////////////*/
+
+ReplayCheck playReplay(const string& assetPath, const Replay& replay) {
+    const ReplayHeader& header = replay.header;
+    ReplayInput input(replay.runs);
+    HeadlessDriver driver(assetPath, header.level, header.seed, &input);
+
+    // a recorder would reseed the level, so playback never records
+    StudentWorld* world = driver.getWorld();
+    world->setRecorder(nullptr);
+    world->setSeekingRobots((header.flags & REPLAY_SEEKING_ROBOTS) != 0);
+
+    // the recording may have started with fewer or more lives than a new game
+    while ((int)world->getLives() > header.startLives)
+        world->decLives();
+    while ((int)world->getLives() < header.startLives)
+        world->incLives();
+
+    HeadlessResult result = driver.run(header.ticks);
+
+    ReplayCheck check;
+    check.ticks = result.ticks;
+    check.score = result.score;
+    check.lives = result.lives;
+    check.stateHash = world->stateHash();
+    check.matches = check.ticks == header.ticks && check.score == header.scoreGained &&
+        check.lives == header.endLives && (header.stateHash == 0 || check.stateHash == header.stateHash);
+    return check;
+}
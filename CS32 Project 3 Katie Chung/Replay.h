@@ -0,0 +1,106 @@
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include "InputSource.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+const uint16_t REPLAY_FILE_VERSION = 2; // 1 had no flags, those replays load with flags 0
+
+// ReplayHeader::flags, world settings the recording was played with
+const uint32_t REPLAY_SEEKING_ROBOTS = 1 << 0; // StudentWorld::setSeekingRobots(true)
+
+// one key (0 = no key) held for length ticks in a row
+struct KeyRun {
+    int key;
+    uint32_t length;
+};
+
+// start of a .mmr replay file, followed by runCount pairs of varints (key, length)
+struct ReplayHeader {
+    char magic[4]; // "MMRP"
+    uint16_t version;
+    uint16_t level;
+    uint64_t seed; // world's random seed when the level started
+    int32_t startLives;
+    int32_t ticks;
+    uint32_t scoreGained;
+    int32_t endLives;
+    uint64_t stateHash; // StudentWorld::stateHash() when the recording ended, 0 if unknown
+    uint32_t runCount;
+    uint32_t flags; // REPLAY_ bits
+};
+
+/*
+ One level played from start to end: the seed, the level, and every key the
+ avatar read, one per tick, run-length encoded. Playing the keys back through
+ a HeadlessDriver with the same seed reproduces the run exactly, so the
+ score, lives and final state hash double as a regression check.
+ */
+
+struct Replay {
+    ReplayHeader header;
+    vector<KeyRun> runs;
+};
+
+bool saveReplay(const string& path, const Replay& replay);
+bool loadReplay(const string& path, Replay& replay);
+
+// collects the keys of each level a world plays + writes them to directory
+class ReplayRecorder {
+public:
+    ReplayRecorder(string directory) : m_directory(directory), m_recording(false), m_startScore(0) {}
+
+    void beginLevel(int level, uint64_t seed, unsigned int score, int lives, uint32_t flags);
+    void recordKey(int key); // called once per tick
+    bool endLevel(unsigned int score, int lives, uint64_t stateHash); // writes the replay file
+
+    bool isRecording() const { return m_recording; }
+    const Replay& getReplay() const { return m_replay; } // the current or last level
+    string getLastPath() const { return m_lastPath; }
+
+private:
+    string m_directory;
+    bool m_recording;
+    unsigned int m_startScore;
+    Replay m_replay;
+    string m_lastPath;
+};
+
+// feeds a replay's keys back in, one per tick
+class ReplayInput : public InputSource {
+public:
+    ReplayInput(const vector<KeyRun>& runs) : m_runs(runs), m_run(0), m_used(0) {}
+
+    virtual bool getKey(int& ch) {
+        if (m_run >= m_runs.size())
+            return false;
+        ch = m_runs[m_run].key;
+        if (++m_used == m_runs[m_run].length) {
+            m_run++;
+            m_used = 0;
+        }
+        return ch != 0;
+    }
+
+private:
+    const vector<KeyRun>& m_runs;
+    size_t m_run;
+    uint32_t m_used; // ticks of the current run already played
+};
+
+// what playing a replay back produced
+struct ReplayCheck {
+    bool matches; // score, lives, ticks and state hash all came out the same
+    int ticks;
+    unsigned int score;
+    int lives;
+    uint64_t stateHash;
+};
+
+// runs a replay headless as fast as possible + compares it with the recording
+ReplayCheck playReplay(const string& assetPath, const Replay& replay);
+
+#endif // REPLAY_H_
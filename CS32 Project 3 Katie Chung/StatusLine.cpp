@@ -0,0 +1,80 @@
+#include "StatusLine.h"
+using namespace std;
+
+// what goes in front of each field, its minimum width, and what pads it
+static const struct {
+    const char* label;
+    int width;
+    char fill;
+    const char* suffix;
+} LAYOUT[NUM_STATUS_FIELDS] = {
+    { "Score: ", 7, '0', "" },
+    { "  Level: ", 2, '0', "" },
+    { "  Lives: ", 2, ' ', "" },
+    { "  Health: ", 3, ' ', "%" },
+    { "  Ammo: ", 3, ' ', "" },
+    { "  Bonus: ", 4, ' ', "" },
+};
+
+static int numDigits(unsigned int value) {
+    int digits = 1;
+    while (value >= 10) {
+        value /= 10;
+        digits++;
+    }
+    return digits;
+}
+
+StatusLine::StatusLine()
+: m_dirty(true)
+{
+    for (int f = 0; f < NUM_STATUS_FIELDS; f++)
+        m_values[f] = 0;
+    layOut();
+}
+
+void StatusLine::set(StatusField field, unsigned int value) {
+    if (m_values[field] == value)
+        return;
+    m_values[field] = value;
+    m_dirty = true;
+    
+    // the field needs to grow or shrink back, so everything after it moves
+    int width = numDigits(value);
+    if (width < LAYOUT[field].width)
+        width = LAYOUT[field].width;
+    if (width != m_width[field]) {
+        layOut();
+        return;
+    }
+    writeField(field);
+}
+
+// builds the whole line from scratch + records where each field is
+void StatusLine::layOut() {
+    m_text.clear();
+    for (int f = 0; f < NUM_STATUS_FIELDS; f++) {
+        m_text += LAYOUT[f].label;
+        m_pos[f] = m_text.size();
+        m_width[f] = numDigits(m_values[f]);
+        if (m_width[f] < LAYOUT[f].width)
+            m_width[f] = LAYOUT[f].width;
+        m_text.append(m_width[f], ' ');
+        m_text += LAYOUT[f].suffix;
+    }
+    for (int f = 0; f < NUM_STATUS_FIELDS; f++)
+        writeField(StatusField(f));
+}
+
+// writes a field's value right-aligned over its old digits
+void StatusLine::writeField(StatusField field) {
+    unsigned int value = m_values[field];
+    size_t i = m_pos[field] + m_width[field];
+    do {
+        m_text[--i] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    
+    while (i > m_pos[field])
+        m_text[--i] = LAYOUT[field].fill;
+}
@@ -0,0 +1,38 @@
+#ifndef STATUSLINE_H_
+#define STATUSLINE_H_
+
+#include <string>
+using namespace std;
+
+enum StatusField { STATUS_SCORE, STATUS_LEVEL, STATUS_LIVES, STATUS_HEALTH, STATUS_AMMO, STATUS_BONUS, NUM_STATUS_FIELDS };
+
+/*
+ The game status line, kept as one preformatted string.
+
+ Each field has a fixed spot in the string, so changing a value only
+ rewrites that field's digits in place; no stream or new string is made per
+ tick. A value too wide for its field makes the field grow like setw does,
+ which lays the whole line out again.
+ */
+
+class StatusLine {
+public:
+    StatusLine();
+    
+    void set(StatusField field, unsigned int value); // only touches the text if value changed
+    bool isDirty() const { return m_dirty; }
+    void markClean() { m_dirty = false; }
+    const string& getText() const { return m_text; }
+    
+private:
+    void layOut();
+    void writeField(StatusField field);
+    
+    string m_text;
+    unsigned int m_values[NUM_STATUS_FIELDS];
+    size_t m_pos[NUM_STATUS_FIELDS]; // where each field's digits start
+    int m_width[NUM_STATUS_FIELDS]; // how many characters each field has right now
+    bool m_dirty;
+};
+
+#endif // STATUSLINE_H_
@@ -3,21 +3,67 @@
 #include "GraphObject.h"
 #include "Actor.h"
 #include "Level.h"
+#include "Profiler.h"
 #include <string>
 #include <iostream>
-#include <sstream>
+#include <algorithm>
+#include <ctime>
+#include <cstdlib>
 using namespace std;
 
 
 GameWorld* createStudentWorld(string assetPath)
 {
-	return new StudentWorld(assetPath);
+	StudentWorld* world = new StudentWorld(assetPath);
+	world->readEnvironment(); // only the interactive game, headless worlds are set up by whoever makes them
+	return world;
+}
+
+// robots get faster on later levels, but never act more than once every 3 ticks
+static int robotPeriodFor(int level) {
+    return max(3, (28 - level) / 4);
+}
+
+// the profiler scope a robot's doSomething is timed under, one per concrete type
+static const char* robotScopeName(const Actor* robot) {
+    switch (robot->getID()) {
+        case IID_RAGEBOT:
+            return "RageBot";
+        case IID_THIEFBOT:
+            return "RegularThiefBot";
+        default:
+            return "MeanThiefBot";
+    }
+}
+
+// true if any bit strictly between lo and hi is set
+static bool anyBitBetween(const vector<unsigned long long>& bits, int lo, int hi) {
+    int first = lo + 1;
+    int last = hi - 1;
+    if (first > last)
+        return false;
+    
+    for (int word = first / 64; word <= last / 64; word++) {
+        unsigned long long mask = ~0ULL;
+        if (word == first / 64)
+            mask &= ~0ULL << (first % 64);
+        if (word == last / 64 && last % 64 != 63)
+            mask &= (1ULL << (last % 64 + 1)) - 1;
+        if (bits[word] & mask)
+            return true;
+    }
+    return false;
 }
 
 // constructor
 StudentWorld::StudentWorld(string assetPath)
-: GameWorld(assetPath)
-{}
+: GameWorld(assetPath), loadedLevel(-1), haveStartSnapshot(false), worldWidth(0), worldHeight(0),
+  nextActorId(1), robotPeriod(3), activeRadius(ACTIVE_REGION_RADIUS), activeX(0), activeY(0), seekingRobots(false), terrainVersion(0),
+  m_avatar(nullptr), rng(time(nullptr)), m_input(nullptr), m_recorder(nullptr), m_maze(nullptr), m_headless(false)
+{
+    resizeWorld(VIEW_WIDTH, VIEW_HEIGHT);
+    peas.reserve(this, PEA_POOL_CAPACITY);
+}
 
 
 // loads current level's maze from data file + constructs representation of current level
@@ -25,120 +71,246 @@ int StudentWorld::init()
 {
     // initialize data members
     finishLevel = false;
+    crystalsLeft = 0;
     bonus = 1000;
     tick = 0;
     
-    // load current maze details from a level data file
-    string level = "level"; // set level text
-    if (getLevel() < 10) {
-        level += "0"; // only add 0 digit if level is less than 10
-    }
-    level += to_string(getLevel()) + ".txt";
-   
-    // TO BE DELETED !!
-   //qlevel = "level07.txt";
-    // TO BE DELETED !!
-    
-    Level lev(assetPath());
-    Level::LoadResult result = lev.loadLevel(level);
+    robotPeriod = robotPeriodFor(getLevel());
+    robotWheel.reset(robotPeriod);
     
-    if (result == Level::load_fail_file_not_found || getLevel() > 99) {
-        cerr << "Could not find data file\n";
+    // levels past 99 don't exist
+    if (getLevel() > 99) {
+        if (!m_headless)
+            cerr << "Could not find data file\n";
         return GWSTATUS_PLAYER_WON;
     }
-    else if (result == Level::load_fail_bad_format) {
-        cerr << "Level not formatted correctly\n";
-        return GWSTATUS_LEVEL_ERROR;
-    }
-    else if (result == Level::load_success) {
-        cerr << "Successfully loaded level\n";
+    
+    // restarting the same level after a death reuses the maze already loaded
+    if (loadedLevel != (int)getLevel()) {
+        Level::LoadResult result = loadLevelData();
         
-        // get contents at each point of 15x15 grid
-        for (int r = 0; r < VIEW_HEIGHT + 1; r++) {
-            for (int c = 0; c < VIEW_WIDTH + 1; c++) {
-                Level::MazeEntry ge = lev.getContentsOf(r, c);
-                switch(ge) {
-                    case Level::empty:
-                        break;
-                    case Level::exit:
-                        actorList.push_back(new Exit(this, r, c));
-                        break;
-                    case Level::player:
-                        m_avatar = new Avatar(this, r, c);
-                        break;
-                    case Level::horiz_ragebot:
-                        actorList.push_back(new RageBot(this, r, c, 0));
-                        break;
-                    case Level::vert_ragebot:
-                        actorList.push_back(new RageBot(this, r, c, 270));
-                        break;
-                    case Level::thiefbot_factory:
-                        actorList.push_back(new ThiefBotFactory(this, r, c, false));
-                        break;
-                    case Level::mean_thiefbot_factory:
-                        actorList.push_back(new ThiefBotFactory(this, r, c, true));
-                        break;
-                    case Level::wall:
-                        actorList.push_back(new Wall(this, r, c));
-                        break;
-                    case Level::marble:
-                        actorList.push_back(new Marble(this, r, c));
-                        break;
-                    case Level::pit:
-                        actorList.push_back(new Pit(this, r, c));
-                        break;
-                    case Level::crystal:
-                        actorList.push_back(new Crystal(this, r, c));
-                        crystalsLeft++;
-                        break;
-                    case Level::restore_health:
-                        actorList.push_back(new RestoreHealth(this, r, c));
-                        break;
-                    case Level::extra_life:
-                        actorList.push_back(new ExtraLife(this, r, c));
-                        break;
-                    case Level::ammo:
-                        actorList.push_back(new Ammo(this, r, c));
-                        break;
-                }
+        if (result == Level::load_fail_file_not_found) {
+            if (!m_headless)
+                cerr << "Could not find data file\n";
+            return GWSTATUS_PLAYER_WON;
+        }
+        else if (result == Level::load_fail_bad_format) {
+            if (!m_headless)
+                cerr << "Level not formatted correctly\n";
+            return GWSTATUS_LEVEL_ERROR;
+        }
+        if (!m_headless)
+            cerr << "Successfully loaded level\n";
+        loadedLevel = getLevel();
+        haveStartSnapshot = false;
+        resizeWorld(levelData.getWidth(), levelData.getHeight());
+        
+        // a replay starts from a known seed, deaths after this keep using the same generator
+        if (m_recorder != nullptr) {
+            endRecording(); // quit partway through the last level
+            uint64_t seed = rng.next();
+            setSeed(seed);
+            m_recorder->beginLevel(getLevel(), seed, getScore(), getLives(), seekingRobots ? REPLAY_SEEKING_ROBOTS : 0);
+        }
+    }
+    
+    // after the first try, put the level back the way it started instead of rebuilding it
+    if (haveStartSnapshot) {
+        restoreActors(startSnapshot);
+        crystalsLeft = startSnapshot.crystalsLeft;
+        if (crystalsLeft == 0)
+            revealExits();
+        updateActiveRegion(true);
+        return GWSTATUS_CONTINUE_GAME;
+    }
+    
+    // make room for every actor up front
+    walls.reserve(levelData.getCount(Level::wall));
+    exits.reserve(levelData.getCount(Level::exit));
+    pits.reserve(levelData.getCount(Level::pit));
+    marbles.reserve(levelData.getCount(Level::marble));
+    crystals.reserve(levelData.getCount(Level::crystal));
+    restoreHealthGoodies.reserve(levelData.getCount(Level::restore_health));
+    extraLifeGoodies.reserve(levelData.getCount(Level::extra_life));
+    ammoGoodies.reserve(levelData.getCount(Level::ammo));
+    factories.reserve(levelData.getCount(Level::thiefbot_factory) + levelData.getCount(Level::mean_thiefbot_factory));
+    rageBots.reserve(levelData.getCount(Level::horiz_ragebot) + levelData.getCount(Level::vert_ragebot));
+    crystalsLeft = levelData.getCrystals();
+    
+    // get contents at each point of the grid
+    for (int r = 0; r < levelData.getWidth(); r++) {
+        for (int c = 0; c < levelData.getHeight(); c++) {
+            Level::MazeEntry ge = levelData.getContentsOf(r, c);
+            switch(ge) {
+                case Level::empty:
+                    break;
+                case Level::exit:
+                    addActor(exits.create(this, r, c));
+                    break;
+                case Level::player:
+                    m_avatar = avatars.create(this, r, c);
+                    break;
+                case Level::horiz_ragebot:
+                    addActor(rageBots.create(this, r, c, 0));
+                    break;
+                case Level::vert_ragebot:
+                    addActor(rageBots.create(this, r, c, 270));
+                    break;
+                case Level::thiefbot_factory:
+                    addActor(factories.create(this, r, c, false));
+                    break;
+                case Level::mean_thiefbot_factory:
+                    addActor(factories.create(this, r, c, true));
+                    break;
+                case Level::wall:
+                    addActor(walls.create(this, r, c));
+                    break;
+                case Level::marble:
+                    addActor(marbles.create(this, r, c));
+                    break;
+                case Level::pit:
+                    addActor(pits.create(this, r, c));
+                    break;
+                case Level::crystal:
+                    addActor(crystals.create(this, r, c));
+                    break;
+                case Level::restore_health:
+                    addActor(restoreHealthGoodies.create(this, r, c));
+                    break;
+                case Level::extra_life:
+                    addActor(extraLifeGoodies.create(this, r, c));
+                    break;
+                case Level::ammo:
+                    addActor(ammoGoodies.create(this, r, c));
+                    break;
             }
         }
     }
     
+    // a level without crystals starts with the exit open
+    if (crystalsLeft == 0)
+        revealExits();
+    
+    updateActiveRegion(true);
+    takeSnapshot(startSnapshot);
+    haveStartSnapshot = true;
     return GWSTATUS_CONTINUE_GAME;
 }
 
+// loads levelNN.bin if it has been compiled, otherwise parses levelNN.txt
+// a maze given to setMaze() is used for every level instead
+Level::LoadResult StudentWorld::loadLevelData() {
+    if (m_maze != nullptr) {
+        loadedLevel = -1;
+        return levelData.loadCells(m_maze->width, m_maze->height, m_maze->cells);
+    }
+    
+    string level = "level"; // set level text
+    if (getLevel() < 10) {
+        level += "0"; // only add 0 digit if level is less than 10
+    }
+    level += to_string(getLevel());
+    loadedLevel = -1;
+    
+    Level::LoadResult result = levelData.loadCompiled(assetPath() + "/" + level + ".bin");
+    if (result == Level::load_fail_file_not_found)
+        result = levelData.loadText(assetPath(), level + ".txt");
+    return result;
+}
+
+// sizes the grid + line of sight masks for a new map, only called with no actors in the world
+void StudentWorld::resizeWorld(int width, int height) {
+    if (width == worldWidth && height == worldHeight)
+        return;
+    
+    worldWidth = width;
+    worldHeight = height;
+    cells.resize(width, height);
+    rowBlockers.assign(height, vector<unsigned long long>((width + 63) / 64, 0));
+    colBlockers.assign(width, vector<unsigned long long>((height + 63) / 64, 0));
+}
+
 // asks actors to do something + disposing actors
 int StudentWorld::move()
 {
+    PROFILE_SCOPE("tick");
     if (bonus > 0) { bonus--; } // decrement bonus
     tick++; // update tick
     updateDisplayText(); // update game status line
-    m_avatar->doSomething();
+    {
+        PROFILE_SCOPE("Avatar");
+        m_avatar->doSomething();
+    }
+    updateActiveRegion(false); // follow the avatar into a new chunk
     
-    for (auto it = actorList.begin(); it != actorList.end(); it++) {
-        if ((*it)->getStatus()) { // if alive
-            (*it)->doSomething();
+    // run each type in its own batch, stopping once the avatar dies or the level is done
+    // walls and pits never do anything so they are skipped, robots only run on their turn
+    // crystals, goodies and exits only react to the avatar stepping on them
+    // factories + robots outside the active region don't run at all
+    auto act = [this](Actor* actor) {
+        if (actor->getStatus()) // if alive
+            actor->doSomething();
+        return m_avatar->getStatus() && !finishLevel;
+    };
+    auto list = [&act](const char* name, const vector<Actor*>& actors) {
+        PROFILE_SCOPE(name);
+        for (size_t i = 0; i < actors.size(); i++) {
+            if (!act(actors[i]))
+                return false;
+        }
+        return true;
+    };
     
-            if (!m_avatar->getStatus()) {
-                decLives();
-                return GWSTATUS_PLAYER_DIED;
-            }
-            if (finishLevel) {
-                increaseScore(2000 + bonus);
-                return GWSTATUS_FINISHED_LEVEL;
-            }
+    // robots wake up in id order with their types mixed, so each one is timed under its own type
+    auto robots = [this, &act]() {
+        for (size_t i = 0; i < dueRobots.size(); i++) {
+            PROFILE_SCOPE(robotScopeName(dueRobots[i]));
+            if (!act(dueRobots[i]))
+                return false;
         }
-    }
+        return true;
+    };
     
-   // remove newly dead characters
-    for (auto it = actorList.begin(); it != actorList.end(); it++) {
-        if (!(*it)->getStatus()) {
-            delete *it;
-            it = actorList.erase(it);
+    // only marbles that ran out of hit points have anything to do
+    auto marbles = [this, &act]() {
+        PROFILE_SCOPE("Marble");
+        for (size_t i = 0; i < brokenMarbles.size(); i++) {
+            Actor* marble = handles.get(brokenMarbles[i]);
+            if (marble != nullptr)
+                act(marble);
         }
+        brokenMarbles.clear();
+        return m_avatar->getStatus() && !finishLevel;
+    };
+    
+    wakeRobots();
+    updateNavigation();
+    if (workers != nullptr)
+        updateRobotsInParallel();
+    else
+        list("ThiefBotFactory", activeFactories) && robots();
+    rescheduleRobots();
+    
+    m_avatar->getStatus() && !finishLevel && marbles() && advancePeas();
+    
+    // everything actors asked for this tick happens now, before any early return
+    applyEffects();
+    
+    if (!m_avatar->getStatus()) {
+        decLives();
+        if (getLives() == 0) // game over
+            endRecording();
+        return GWSTATUS_PLAYER_DIED;
     }
-        
+    if (finishLevel) {
+        GameWorld::increaseScore(2000 + bonus);
+        endRecording();
+        return GWSTATUS_FINISHED_LEVEL;
+    }
+    
+    // remove newly dead characters
+    removeDeadActors();
+    
 	return GWSTATUS_CONTINUE_GAME;
 }
 
@@ -146,47 +318,70 @@ int StudentWorld::move()
 void StudentWorld::cleanUp()
 {
     // deletes avatar object
-    delete m_avatar;
+    avatars.clear();
     m_avatar = nullptr;
     
-    // looping through list and deallocating memory
-    for (auto a : actorList)
-        delete a;
-    actorList.clear();
+    // destroy every actor, the pools keep their memory for the next level
+    // peas are only hidden so the next level can reuse them
+    walls.clear();
+    exits.clear();
+    pits.clear();
+    marbles.clear();
+    crystals.clear();
+    restoreHealthGoodies.clear();
+    extraLifeGoodies.clear();
+    ammoGoodies.clear();
+    factories.clear();
+    rageBots.clear();
+    regularThiefBots.clear();
+    meanThiefBots.clear();
+    peas.clear();
+    
+    // empty every cell of the occupancy grid, which also zeroes the per-cell counts
+    cells.clear();
+    nextActorId = 1;
+    handles.clear();
+    robotWheel.clear();
+    brokenMarbles.clear();
+    activeFactories.clear();
+    tombstones.clear(); // includes peas that were hidden above
+    effects.clear();
+    terrainVersion++; // the distance fields are built again for whatever is loaded next
+    
+    // no blockers left either
+    for (auto& row : rowBlockers)
+        fill(row.begin(), row.end(), 0);
+    for (auto& col : colBlockers)
+        fill(col.begin(), col.end(), 0);
 }
 
 // destructor
 StudentWorld::~StudentWorld()
 {
+    endRecording();
     cleanUp();
 }
 
-// function for displaying text
+// function for displaying text, only the fields that changed get rewritten
 void StudentWorld::updateDisplayText() {
-    ostringstream oss; // declares ostringstream object
-    oss << "Score: "; // appends "Score: "
-    oss.fill('0'); // sets fill character to '0', will fill spaces
-    oss << setw(7) << getScore(); // sets the width to 6 and adds score
-    
-    oss << "  Level: ";
-    oss.fill('0');
-    oss << setw(2) << getLevel();
-    
-    oss << "  Lives: ";
-    oss.fill(' ');
-    oss << setw(2) << getLives();
-
-    oss << "  Health: ";
-    oss << setw(3) << (m_avatar->getHealth() / 20.0) * 100 << "%";
+    if (m_headless) // nothing to show it on
+        return;
     
-    oss << "  Ammo: ";
-    oss << setw(3) << m_avatar->getAmmo();
+    int health = m_avatar->getHealth();
+    if (health < 0)
+        health = 0;
     
-    oss << "  Bonus: ";
-    oss << setw(4) << bonus;
+    statusLine.set(STATUS_SCORE, getScore());
+    statusLine.set(STATUS_LEVEL, getLevel());
+    statusLine.set(STATUS_LIVES, getLives());
+    statusLine.set(STATUS_HEALTH, health * 100 / 20); // percent of 20 hp
+    statusLine.set(STATUS_AMMO, m_avatar->getAmmo());
+    statusLine.set(STATUS_BONUS, bonus);
     
-    string s = oss.str();
-    setGameStatText(s);
+    if (statusLine.isDirty()) {
+        setGameStatText(statusLine.getText());
+        statusLine.markClean();
+    }
 }
 
 /* ///////////////////////////////////////////////////
@@ -197,37 +392,83 @@ void StudentWorld::updateDisplayText() {
  
  ///////////////////////////////////////////////////*/
 
+// the square next to cell in direction dir, NO_CELL past the edge
+Cell StudentWorld::neighborCell(Cell cell, int dir) const {
+    int x = cellX(cell);
+    int y = cellY(cell);
+    switch (dir) {
+        case GraphObject::up:
+            return cellAt(x, y + 1);
+        case GraphObject::down:
+            return cellAt(x, y - 1);
+        case GraphObject::left:
+            return cellAt(x - 1, y);
+        case GraphObject::right:
+            return cellAt(x + 1, y);
+    }
+    return cell;
+}
+
 // returns the actor at a specific position
-Actor* StudentWorld::getActorAtPos(double x, double y) {
-    if (m_avatar->getX() == x && m_avatar->getY() == y)
+Actor* StudentWorld::getActorAtPos(Cell cell) {
+    PROFILE_QUERY(QUERY_GET_ACTOR_AT_POS);
+    if (m_avatar->getCell() == cell)
         return m_avatar;
     
-    for (auto it = actorList.begin(); it != actorList.end(); it++) {
-        if ((*it)->getX() == x && (*it)->getY() == y)
-            return *it;
+    if (cell == NO_CELL)
+        return nullptr;
+    const vector<Actor*>& actors = cells.actorsAt(cell);
+    if (actors.empty())
+        return nullptr;
+    PROFILE_SCANNED(QUERY_GET_ACTOR_AT_POS, 1);
+    return actors.front();
+}
+
+int StudentWorld::getActorCount() const {
+    return walls.size() + exits.size() + pits.size() + marbles.size() + crystals.size() +
+        restoreHealthGoodies.size() + extraLifeGoodies.size() + ammoGoodies.size() +
+        factories.size() + rageBots.size() + regularThiefBots.size() + meanThiefBots.size() +
+        peas.size();
+}
+
+// settings for the interactive game that come from environment variables
+void StudentWorld::readEnvironment() {
+    const char* recordDir = getenv("MM_RECORD_DIR");
+    if (recordDir != nullptr) {
+        envRecorder.reset(new ReplayRecorder(recordDir));
+        m_recorder = envRecorder.get();
     }
-    return nullptr;
+    if (getenv("MM_SEEKING_ROBOTS") != nullptr)
+        seekingRobots = true;
 }
 
 /* /////////////// PLAYER FUNCTIONS ///////////////////*/
 
-int StudentWorld::getPlayerDirection() {
-    return m_avatar->getDirection();
+// reads the next key from the input source, or the keyboard if there isn't one
+bool StudentWorld::getPlayerKey(int& ch) {
+    bool gotKey = (m_input != nullptr) ? m_input->getKey(ch) : getKey(ch);
+    if (m_recorder != nullptr)
+        m_recorder->recordKey(gotKey ? ch : 0);
+    return gotKey;
 }
 
-bool StudentWorld::onSameSquareAsPlayer(double x, double y) {
-    return (m_avatar->getX() == x && m_avatar->getY() == y);
+int StudentWorld::getPlayerDirection() {
+    return m_avatar->getDirection();
 }
 
 // check if player can move to location
-bool StudentWorld::isInBounds(double x, double y) {
-    if (x < 0 || x > VIEW_WIDTH - 1 || y < 0 || y > VIEW_HEIGHT - 1)
+bool StudentWorld::isInBounds(Cell cell) {
+    PROFILE_QUERY(QUERY_IS_IN_BOUNDS);
+    if (cell == NO_CELL)
         return false;
     
-    for (auto it = actorList.begin(); it != actorList.end(); it++) {
-        if ((*it)->getX() == x && (*it)->getY() == y && !(*it)->avatarOverlap()) {
-            if ((*it)->canPush())
-                return true;
+    const vector<Actor*>& actors = cells.actorsAt(cell);
+    PROFILE_SCANNED(QUERY_IS_IN_BOUNDS, actors.size());
+    for (size_t i = 0; i < actors.size(); i++) {
+        if (!actors[i]->hasTrait(TRAIT_AVATAR_OVERLAP)) {
+            // only marbles can be pushed
+            if (actors[i]->hasTrait(TRAIT_PUSHABLE))
+                return static_cast<Marble*>(actors[i])->pushMarble(getPlayerDirection());
             else
                 return false;
         }
@@ -237,22 +478,27 @@ bool StudentWorld::isInBounds(double x, double y) {
 
 /* ///////////////// MARBLE FUNCTION //////////////////*/
 
-bool StudentWorld::canMarbleMove(Actor* actor, double x, double y) {
+bool StudentWorld::canMarbleMove(Actor* actor, Cell cell) {
+    PROFILE_QUERY(QUERY_CAN_MARBLE_MOVE);
+    if (cell == NO_CELL) // can't be pushed out of the world
+        return false;
     
-    for (auto it = actorList.begin(); it != actorList.end(); it++) {
-        if ((*it)->getX() == x && (*it)->getY() == y && !(*it)->marbleOverlap()) {
-            return false;
-        }
-        if ((*it)->getX() == x && (*it)->getY() == y && (*it)->marbleOverlap()) { // only object it can overlap is a pit
-            // delete the marble
-            actor->updateStatus(false);
-            actor->setVisible(false);
-            
-            // destroy the pit
-            (*it)->die();
-            return true;
-        }
-    }
+    const vector<Actor*>& actors = cells.actorsAt(cell);
+    PROFILE_SCANNED(QUERY_CAN_MARBLE_MOVE, actors.empty() ? 0 : 1);
+    if (actors.empty())
+        return true;
+    
+    Actor* other = actors.front(); // first actor in the cell decides
+    if (!other->hasTrait(TRAIT_MARBLE_OVERLAP))
+        return false;
+    
+    // only object it can overlap is a pit
+    // delete the marble
+    actor->updateStatus(false);
+    actor->setVisible(false);
+    
+    // destroy the pit
+    other->die();
     return true;
 }
 
@@ -278,128 +524,192 @@ void StudentWorld::foundCrystal() {
     increaseScore(50);
     crystalsLeft--;
     
-    if (crystalsLeft == 0)
+    if (crystalsLeft == 0) {
+        revealExits();
         playSound(SOUND_REVEAL_EXIT);
+    }
+}
+
+void StudentWorld::revealExits() {
+    exits.forEach([](Exit* exit) {
+        exit->setVisible(true);
+        return true;
+    });
 }
 
 /* //////////// PEA FUNCTIONS /////////////*/
 
 // returns 1, 2, or 3 depending on collision
-int StudentWorld::overlapPea(double x, double y) {
-    if (m_avatar->getX() == x && m_avatar->getY() == y && m_avatar->canPeaDamage()) {
-        //cerr << "damage player" << endl;
+int StudentWorld::overlapPea(Cell cell) {
+    PROFILE_QUERY(QUERY_OVERLAP_PEA);
+    if (m_avatar->getCell() == cell) {
+        m_avatar->takePeaHit();
         return 1;
     }
     
-    for (auto it = actorList.begin(); it != actorList.end(); it++) {
-        if ((*it)->getX() == x && (*it)->getY() == y) {
-            if ((*it)->canPeaDamage()) {
-                //cerr << "damage robot" << endl;
-                return 1;
-            }
-            if ((*it)->canPeaHit()) {
-                //cerr << "thing2" << endl;
-                return 2;
-            }
-            if (!(*it)->canPeaDamage() && !(*it)->canPeaHit() && (*it)->isObjectDetectable()) {
-                //cerr << "thing3" << endl;
-                return 3;
-            }
+    if (cell == NO_CELL)
+        return -1;
+    
+    const vector<Actor*>& actors = cells.actorsAt(cell);
+    PROFILE_SCANNED(QUERY_OVERLAP_PEA, actors.size());
+    for (size_t i = 0; i < actors.size(); i++) {
+        if (actors[i]->hasTrait(TRAIT_PEA_DAMAGE)) { // damage robot/marble
+            actors[i]->takePeaHit();
+            return 1;
         }
+        if (actors[i]->hasTrait(TRAIT_PEA_HIT)) {
+            // a factory lets the pea through to the thiefbot sitting on it
+            if (actors[i]->hasTrait(TRAIT_FACTORY) && onSameSquareAsThiefBot(cell))
+                continue;
+            return 2;
+        }
+        if (actors[i]->isObjectDetectable())
+            return 3;
     }
     return -1; // error
 }
 
-// creates pea object and adds to actorList
-void StudentWorld::constructPea(double x, double y, int direction) {
-    actorList.push_back(new Pea(this, x, y, direction));
+// queues a pea, it's taken from the pool at the end of the tick
+void StudentWorld::constructPea(Cell cell, int direction) {
+    if (cell == NO_CELL) // fired at the edge of the world, there is nowhere for it to go
+        return;
+    effects.spawn(SPAWN_PEA, cell, direction);
+}
+
+// puts a pea from the pool in play on cell, which has to be on the map, the caller adds it to the world
+Pea* StudentWorld::firePea(Cell cell, int direction) {
+    return peas.fire(cell, cellX(cell), cellY(cell), direction);
+}
+
+// moves every pea in firing order, stopping if the avatar dies
+// a pea with nothing that stops peas on its square or the next one would just fly on,
+// so it is moved straight from its lanes, any other pea takes the exact check in Pea::doSomething
+bool StudentWorld::advancePeas() {
+    PROFILE_SCOPE("Pea");
+    PeaLanes& lanes = peas.lanes();
+    peas.step(peaNextX, peaNextY);
+    
+    // peas only stop on pea-blocking actors + the avatar, and neither moves while peas do
+    int avatarX = cellX(m_avatar->getCell());
+    int avatarY = cellY(m_avatar->getCell());
+    auto clear = [&](int x, int y) {
+        if (x < 0 || y < 0 || x >= worldWidth || y >= worldHeight)
+            return false;
+        if (x == avatarX && y == avatarY)
+            return false;
+        return !(rowBlockers[y][x / 64] >> (x % 64) & 1);
+    };
+    
+    for (int i = 0; i < peas.size(); i++) {
+        if (!lanes.alive[i])
+            continue;
+        int nextX = peaNextX[i];
+        int nextY = peaNextY[i];
+        Pea* pea = peas.at(i);
+        if (clear(lanes.x[i], lanes.y[i]) && clear(nextX, nextY)) {
+            pea->moveTo(cellAt(nextX, nextY));
+            lanes.x[i] = nextX;
+            lanes.y[i] = nextY;
+            continue;
+        }
+        
+        pea->doSomething();
+        lanes.alive[i] = pea->getStatus();
+        if (pea->getCell() != NO_CELL) {
+            lanes.x[i] = cellX(pea->getCell());
+            lanes.y[i] = cellY(pea->getCell());
+        }
+        if (!m_avatar->getStatus() || finishLevel)
+            return false;
+    }
+    return true;
 }
 
 /* ///////////////// ROBOT FUNCTIONS /////////////////*/
 
-void StudentWorld::constructMeanThiefBot(double x, double y) {
-    actorList.push_back(new MeanThiefBot(this, x, y));
+void StudentWorld::constructMeanThiefBot(Cell cell) {
+    effects.spawn(SPAWN_MEAN_THIEFBOT, cell, GraphObject::none);
     playSound(SOUND_ROBOT_BORN);
 }
 
-void StudentWorld::constructRegularThiefBot(double x, double y) {
-    actorList.push_back(new RegularThiefBot(this, x, y));
+void StudentWorld::constructRegularThiefBot(Cell cell) {
+    effects.spawn(SPAWN_REGULAR_THIEFBOT, cell, GraphObject::none);
     playSound(SOUND_ROBOT_BORN);
 }
 
-bool StudentWorld::onSameSquareAsGoodie(double x, double y) {
-    for (auto it = actorList.begin(); it != actorList.end(); it++) {
-        if ((*it)->isCollectable() && x == (*it)->getX() && y == (*it)->getY())
+bool StudentWorld::onSameSquareAsGoodie(Cell cell) {
+    PROFILE_QUERY(QUERY_ON_SAME_SQUARE_AS_GOODIE);
+    if (cell == NO_CELL)
+        return false;
+    
+    const vector<Actor*>& actors = cells.actorsAt(cell);
+    PROFILE_SCANNED(QUERY_ON_SAME_SQUARE_AS_GOODIE, actors.size());
+    for (size_t i = 0; i < actors.size(); i++) {
+        if (actors[i]->hasTrait(TRAIT_COLLECTABLE))
             return true;
     }
     return false;
 }
 
-int StudentWorld::countSurroundingThiefBots(double x, double y) {
-    int count = 0;
-    for (auto it = actorList.begin(); it != actorList.end(); it++) {
-        int posX = (*it)->getX();
-        int posY = (*it)->getY();
-        if ((*it)->isThiefBot() && posX > x - 3 && posX < x + 3 && posY > y - 3 && posY < y + 3) // in the 3 squares radius
-            count++;
-    }
-    return count;
+// thiefbots in the 5x5 square around cell, kept up to date as they are added, move and get removed
+int StudentWorld::countSurroundingThiefBots(Cell cell) {
+    PROFILE_QUERY(QUERY_COUNT_SURROUNDING_THIEFBOTS); // answered from the window counts, nothing scanned
+    if (cell == NO_CELL)
+        return 0;
+    const WorldChunk* chunk = cells.find(cells.chunkOf(cell));
+    return chunk != nullptr ? chunk->nearbyThiefBots[ChunkGrid::squareOf(cell)] : 0;
 }
 
-bool StudentWorld::canRobotMove(Actor* actor, double x, double y) const {
-    if (m_avatar->getX() == x && m_avatar->getY() == y)
+bool StudentWorld::canRobotMove(Cell cell) const {
+    PROFILE_QUERY(QUERY_CAN_ROBOT_MOVE);
+    if (m_avatar->getCell() == cell)
         return false;
     
-    for (auto it = actorList.begin(); it != actorList.end(); it++) {
-        if ((*it)->getX() == x && (*it)->getY() == y && !(*it)->avatarOverlap()) {
+    if (cell == NO_CELL)
+        return false;
+    
+    const vector<Actor*>& actors = cells.actorsAt(cell);
+    PROFILE_SCANNED(QUERY_CAN_ROBOT_MOVE, actors.size());
+    for (size_t i = 0; i < actors.size(); i++) {
+        if (!actors[i]->hasTrait(TRAIT_AVATAR_OVERLAP))
             return false;
-        }
     }
     return true;
 }
 
-bool StudentWorld::robotCanShootPlayer(double x, double y, int dir) {
+bool StudentWorld::robotCanShootPlayer(Cell cell, int dir) {
+    PROFILE_QUERY(QUERY_ROBOT_CAN_SHOOT_PLAYER); // answered from the blocker masks, nothing scanned
     // up - 1, down - 2, left - 3, right - 4
     
-    if (!sameRowColAsPlayer(x, y, dir))
+    if (!sameRowColAsPlayer(cell, dir))
         return false;
     
-    double playerX = m_avatar->getX();
-    double playerY = m_avatar->getY();
+    int robotX = cellX(cell);
+    int robotY = cellY(cell);
+    int playerX = cellX(m_avatar->getCell());
+    int playerY = cellY(m_avatar->getCell());
 
-    for (auto it = actorList.begin(); it != actorList.end(); it++) {
-        // check if there is an obstacle in that row/column
-        
-        double obstacleX = (*it)->getX();
-        double obstacleY = (*it)->getY();
-        
-        switch(dir) {
-            case 1:
-                if ((*it)->canPeaHit() && obstacleX == x && obstacleY > y && obstacleY < playerY)
-                    return false;
-                break;
-            case 2:
-                if ((*it)->canPeaHit() && obstacleX == x && obstacleY < y && obstacleY > playerY)
-                    return false;
-                break;
-            case 3:
-                if ((*it)->canPeaHit() && obstacleY == y && obstacleX < x && obstacleX > playerX)
-                    return false;
-                break;
-            case 4:
-                if ((*it)->canPeaHit() && obstacleY == y && obstacleX > x && obstacleX < playerX)
-                    return false;
-                break;
-        }
+    // check if there is an obstacle in that row/column
+    switch(dir) {
+        case 1:
+            return !anyBitBetween(colBlockers[robotX], robotY, playerY);
+        case 2:
+            return !anyBitBetween(colBlockers[robotX], playerY, robotY);
+        case 3:
+            return !anyBitBetween(rowBlockers[robotY], playerX, robotX);
+        case 4:
+            return !anyBitBetween(rowBlockers[robotY], robotX, playerX);
     }
     return true;
 }
 
-bool StudentWorld::sameRowColAsPlayer(double x, double y, int dir) {
+bool StudentWorld::sameRowColAsPlayer(Cell cell, int dir) {
     // up - 1, down - 2, left - 3, right - 4
         
-    double playerX = m_avatar->getX();
-    double playerY = m_avatar->getY();
+    int x = cellX(cell);
+    int y = cellY(cell);
+    int playerX = cellX(m_avatar->getCell());
+    int playerY = cellY(m_avatar->getCell());
     
     // check if player is in the same row/col
     switch(dir) {
@@ -424,10 +734,678 @@ bool StudentWorld::sameRowColAsPlayer(double x, double y, int dir) {
 }
 
 
-bool StudentWorld::onSameSquareAsThiefBot(double x, double y) {
-    for (auto it = actorList.begin(); it != actorList.end(); it++) {
-        if (x == (*it)->getX() && y == (*it)->getY() && (*it)->isThiefBot())
+bool StudentWorld::onSameSquareAsThiefBot(Cell cell) {
+    PROFILE_QUERY(QUERY_ON_SAME_SQUARE_AS_THIEFBOT);
+    if (cell == NO_CELL)
+        return false;
+    
+    const vector<Actor*>& actors = cells.actorsAt(cell);
+    PROFILE_SCANNED(QUERY_ON_SAME_SQUARE_AS_THIEFBOT, actors.size());
+    for (size_t i = 0; i < actors.size(); i++) {
+        if (actors[i]->hasTrait(TRAIT_THIEFBOT))
             return true;
     }
     return false;
 }
+
+/* ///////////////// REPLAYS /////////////////*/
+
+// writes out the level being recorded, if there is one
+void StudentWorld::endRecording() {
+    if (m_recorder == nullptr || !m_recorder->isRecording())
+        return;
+    if (!m_recorder->endLevel(getScore(), getLives(), stateHash()) && !m_headless)
+        cerr << "Could not write replay " << m_recorder->getLastPath() << "\n";
+}
+
+/* ///////////////// PARALLEL UPDATE /////////////////*/
+
+void StudentWorld::setParallelUpdate(int numThreads) {
+    if (numThreads <= 0)
+        workers.reset();
+    else
+        workers.reset(new WorkerGroup(numThreads));
+}
+
+// plans every factory + robot due this tick at once against the world as it is now,
+// then applies their intents one at a time in the normal update order
+void StudentWorld::updateRobotsInParallel() {
+    planners.clear();
+    planners.assign(activeFactories.begin(), activeFactories.end());
+    planners.insert(planners.end(), dueRobots.begin(), dueRobots.end());
+    intents.resize(planners.size());
+    
+    // each actor gets its own generator seeded from the tick + its id,
+    // so the result doesn't depend on how many threads there are
+    uint64_t tickSeed = rng.next();
+    tickSeed = (tickSeed << 32) | rng.next();
+    workers->run(planners.size(), [this, tickSeed](int begin, int end) {
+        PROFILE_SCOPE("planIntent");
+        for (int i = begin; i < end; i++) {
+            RandomGenerator actorRng(tickSeed ^ (planners[i]->getId() * 0x9E3779B97F4A7C15ULL));
+            planners[i]->planIntent(intents[i], actorRng);
+        }
+    });
+    
+    PROFILE_SCOPE("applyIntent");
+    for (size_t i = 0; i < planners.size(); i++)
+        planners[i]->applyIntent(intents[i]);
+}
+
+/* ///////////////// ROBOT SCHEDULE /////////////////*/
+
+// robots act on every tick that is a multiple of robotPeriod, this schedules the first one after after
+void StudentWorld::scheduleRobot(Actor* robot, int after) {
+    int due = (after / robotPeriod + 1) * robotPeriod;
+    robotWheel.schedule(robot->getId(), robot->getHandle(), due);
+}
+
+// collects the robots whose turn it is, ones that died while asleep are dropped
+// and ones outside the active region are parked in their chunk until it wakes up
+void StudentWorld::wakeRobots() {
+    robotWheel.takeDue(tick, dueHandles);
+    dueRobots.clear();
+    for (size_t i = 0; i < dueHandles.size(); i++) {
+        Actor* robot = handles.get(dueHandles[i]);
+        if (robot == nullptr || !robot->getStatus())
+            continue;
+        
+        int chunk = cells.chunkOf(robot->getCell());
+        if (isChunkActive(chunk))
+            dueRobots.push_back(robot);
+        else
+            cells.get(chunk).sleepers.push_back(dueHandles[i]);
+    }
+}
+
+// puts the robots that just had their turn back to sleep until their next one
+void StudentWorld::rescheduleRobots() {
+    for (size_t i = 0; i < dueRobots.size(); i++) {
+        if (dueRobots[i]->getStatus())
+            scheduleRobot(dueRobots[i], tick);
+    }
+}
+
+/* ///////////////// NAVIGATION /////////////////*/
+
+// builds the distance fields the robots due this tick steer by, every robot planning this tick sees the same ones
+// a field is only searched again when its targets, the terrain or the active region changed
+void StudentWorld::updateNavigation() {
+    if (!seekingRobots || dueRobots.empty())
+        return;
+    PROFILE_SCOPE("Navigation");
+    
+    int left = 0;
+    int bottom = 0;
+    int right = worldWidth;
+    int top = worldHeight;
+    if (activeRadius >= 0) {
+        left = max(0, activeX - activeRadius) << WORLD_CHUNK_SHIFT;
+        bottom = max(0, activeY - activeRadius) << WORLD_CHUNK_SHIFT;
+        right = min(right, (activeX + activeRadius + 1) << WORLD_CHUNK_SHIFT);
+        top = min(top, (activeY + activeRadius + 1) << WORLD_CHUNK_SHIFT);
+    }
+    auto blocked = [this](int x, int y) {
+        Cell cell = cells.pack(x, y);
+        const WorldChunk* chunk = cells.find(cells.chunkOf(cell));
+        return chunk != nullptr && chunk->terrainCount[ChunkGrid::squareOf(cell)] > 0;
+    };
+    
+    // goodies lying around, not the ones thiefbots are carrying
+    navTargets.clear();
+    auto addGoodie = [this](Actor* goodie) {
+        if (goodie->getStatus() && goodie->isObjectDetectable())
+            navTargets.push_back(make_pair(cellX(goodie->getCell()), cellY(goodie->getCell())));
+        return true;
+    };
+    restoreHealthGoodies.forEach(addGoodie);
+    extraLifeGoodies.forEach(addGoodie);
+    ammoGoodies.forEach(addGoodie);
+    if (!goodieField.isBuiltFor(left, bottom, right - left, top - bottom, navTargets, terrainVersion))
+        goodieField.build(left, bottom, right - left, top - bottom, navTargets, terrainVersion, blocked);
+    
+    navTargets.clear();
+    navTargets.push_back(make_pair(cellX(m_avatar->getCell()), cellY(m_avatar->getCell())));
+    if (!playerField.isBuiltFor(left, bottom, right - left, top - bottom, navTargets, terrainVersion))
+        playerField.build(left, bottom, right - left, top - bottom, navTargets, terrainVersion, blocked);
+}
+
+// direction of the free neighbor of robot that is closest to target, none if no step gets it closer
+// only reads the fields, so it is safe to call while planning in parallel
+int StudentWorld::stepToward(const Actor* robot, NavigationTarget target) const {
+    const DistanceField& field = target == NAVIGATE_TO_PLAYER ? playerField : goodieField;
+    static const int directions[4] = { GraphObject::up, GraphObject::down, GraphObject::left, GraphObject::right };
+    static const int offsetX[4] = { 0, 0, -1, 1 };
+    static const int offsetY[4] = { 1, -1, 0, 0 };
+    
+    int x = cellX(robot->getCell());
+    int y = cellY(robot->getCell());
+    int here = field.distance(x, y);
+    int distances[4];
+    for (int d = 0; d < 4; d++)
+        distances[d] = field.distance(x + offsetX[d], y + offsetY[d]);
+    
+    // the closest neighbor first, a later one only if a robot or pea is in the way
+    for (int tries = 0; tries < 4; tries++) {
+        int best = -1;
+        for (int d = 0; d < 4; d++) {
+            if (distances[d] < here && (best < 0 || distances[d] < distances[best]))
+                best = d;
+        }
+        if (best < 0)
+            break;
+        if (canRobotMove(cellAt(x + offsetX[best], y + offsetY[best])))
+            return directions[best];
+        distances[best] = NO_DISTANCE;
+    }
+    return GraphObject::none;
+}
+
+/* ///////////////// ACTIVE REGION /////////////////*/
+
+void StudentWorld::setActiveRadius(int radius) {
+    activeRadius = radius;
+    if (m_avatar != nullptr)
+        updateActiveRegion(true);
+}
+
+bool StudentWorld::isChunkActive(int chunk) const {
+    if (activeRadius < 0)
+        return true;
+    return abs(cells.chunkX(chunk) - activeX) <= activeRadius && abs(cells.chunkY(chunk) - activeY) <= activeRadius;
+}
+
+// centers the active region on the avatar's chunk, only does anything when that chunk changed
+// parked robots in the region get their next turn (this tick's, if it is one) + its factories start running
+void StudentWorld::updateActiveRegion(bool force) {
+    int chunk = cells.chunkOf(m_avatar->getCell());
+    int x = cells.chunkX(chunk);
+    int y = cells.chunkY(chunk);
+    if (!force && (activeRadius < 0 || (x == activeX && y == activeY)))
+        return;
+    activeX = x;
+    activeY = y;
+    
+    int minX = 0;
+    int maxX = cells.chunksWide() - 1;
+    int minY = 0;
+    int maxY = cells.chunksHigh() - 1;
+    if (activeRadius >= 0) {
+        minX = max(minX, x - activeRadius);
+        maxX = min(maxX, x + activeRadius);
+        minY = max(minY, y - activeRadius);
+        maxY = min(maxY, y + activeRadius);
+    }
+    
+    activeFactories.clear();
+    for (int cy = minY; cy <= maxY; cy++) {
+        for (int cx = minX; cx <= maxX; cx++) {
+            WorldChunk* active = cells.find(cells.chunkAt(cx, cy));
+            if (active == nullptr)
+                continue;
+            
+            activeFactories.insert(activeFactories.end(), active->factories.begin(), active->factories.end());
+            for (size_t i = 0; i < active->sleepers.size(); i++) {
+                Actor* robot = handles.get(active->sleepers[i]);
+                if (robot != nullptr && robot->getStatus())
+                    scheduleRobot(robot, tick - 1);
+            }
+            active->sleepers.clear();
+        }
+    }
+    
+    // the same order as the factories pool when the whole map is active
+    sort(activeFactories.begin(), activeFactories.end(), [](Actor* a, Actor* b) { return a->getId() < b->getId(); });
+}
+
+/* ///////////////// EFFECTS /////////////////*/
+
+// applies the effects queued this tick: score, then new actors, then sounds
+void StudentWorld::applyEffects() {
+    PROFILE_SCOPE("applyEffects");
+    if (effects.getScore() > 0)
+        GameWorld::increaseScore(effects.getScore());
+    
+    const vector<SpawnEffect>& spawns = effects.getSpawns();
+    for (size_t i = 0; i < spawns.size(); i++) {
+        Cell cell = spawns[i].cell;
+        switch (spawns[i].type) {
+            case SPAWN_PEA: {
+                // in play only after this tick's moves, so a pea never moves on the tick it was fired
+                addActor(firePea(cell, spawns[i].direction));
+                break;
+            }
+            case SPAWN_REGULAR_THIEFBOT:
+                addActor(regularThiefBots.create(this, cellX(cell), cellY(cell)));
+                break;
+            case SPAWN_MEAN_THIEFBOT:
+                addActor(meanThiefBots.create(this, cellX(cell), cellY(cell)));
+                break;
+        }
+    }
+    
+    const vector<int>& sounds = effects.getSounds();
+    for (size_t i = 0; i < sounds.size(); i++)
+        GameWorld::playSound(sounds[i]);
+    
+    effects.clear();
+}
+
+/* ///////////////// SNAPSHOTS /////////////////*/
+
+// fills in the parts of a record every actor has
+static ActorRecord recordOf(Actor* actor, SnapshotType type, int slot) {
+    ActorRecord rec = {};
+    rec.id = actor->getId();
+    rec.slot = slot;
+    rec.type = type;
+    if (actor->getStatus())
+        rec.flags |= SNAP_ALIVE;
+    if (actor->isObjectDetectable())
+        rec.flags |= SNAP_DETECTABLE;
+    rec.x = actor->getX();
+    rec.y = actor->getY();
+    rec.direction = actor->getDirection();
+    return rec;
+}
+
+// copies the state of the world into snapshot, reusing its memory
+void StudentWorld::takeSnapshot(WorldSnapshot& snapshot) {
+    snapshot.level = getLevel();
+    snapshot.tick = tick;
+    snapshot.bonus = bonus;
+    snapshot.crystalsLeft = crystalsLeft;
+    snapshot.finishLevel = finishLevel;
+    snapshot.nextActorId = nextActorId;
+    snapshot.rng = rng;
+    
+    vector<ActorRecord>& records = snapshot.actors;
+    records.clear();
+    
+    ActorRecord player = recordOf(m_avatar, SNAP_AVATAR, 0);
+    player.health = m_avatar->getHealth();
+    player.ammo = m_avatar->getAmmo();
+    records.push_back(player);
+    
+    // actors with nothing but a position
+    auto save = [&records](SnapshotType type) {
+        return [&records, type](Actor* actor, int slot) {
+            records.push_back(recordOf(actor, type, slot));
+            return true;
+        };
+    };
+    walls.forEachWithSlot(save(SNAP_WALL));
+    exits.forEachWithSlot(save(SNAP_EXIT));
+    pits.forEachWithSlot(save(SNAP_PIT));
+    crystals.forEachWithSlot(save(SNAP_CRYSTAL));
+    restoreHealthGoodies.forEachWithSlot(save(SNAP_RESTORE_HEALTH));
+    extraLifeGoodies.forEachWithSlot(save(SNAP_EXTRA_LIFE));
+    ammoGoodies.forEachWithSlot(save(SNAP_AMMO));
+    
+    marbles.forEachWithSlot([&records](Marble* marble, int slot) {
+        ActorRecord rec = recordOf(marble, SNAP_MARBLE, slot);
+        rec.health = marble->getHitPoints();
+        records.push_back(rec);
+        return true;
+    });
+    factories.forEachWithSlot([&records](ThiefBotFactory* factory, int slot) {
+        ActorRecord rec = recordOf(factory, SNAP_FACTORY, slot);
+        if (factory->isMeanThiefBotFactory())
+            rec.flags |= SNAP_MEAN;
+        records.push_back(rec);
+        return true;
+    });
+    rageBots.forEachWithSlot([&records](RageBot* bot, int slot) {
+        ActorRecord rec = recordOf(bot, SNAP_RAGEBOT, slot);
+        rec.health = bot->getHealth();
+        records.push_back(rec);
+        return true;
+    });
+    
+    auto saveThiefBot = [&records](SnapshotType type) {
+        return [&records, type](ThiefBot* bot, int slot) {
+            ActorRecord rec = recordOf(bot, type, slot);
+            rec.health = bot->getHealth();
+            rec.distanceMoved = bot->getDistanceMoved();
+            rec.maxDistance = bot->getMaxDistance();
+            if (bot->robotHasGoodie() && bot->myGoodie() != nullptr)
+                rec.goodieId = bot->myGoodie()->getId();
+            records.push_back(rec);
+            return true;
+        };
+    };
+    regularThiefBots.forEachWithSlot(saveThiefBot(SNAP_REGULAR_THIEFBOT));
+    meanThiefBots.forEachWithSlot(saveThiefBot(SNAP_MEAN_THIEFBOT));
+    
+    // peas are kept in the order they were fired, which is the order they get restored in
+    for (int i = 0; i < peas.size(); i++) {
+        records.push_back(recordOf(peas.at(i), SNAP_PEA, 0));
+    }
+}
+
+uint64_t StudentWorld::stateHash() {
+    if (m_avatar == nullptr)
+        return 0;
+    WorldSnapshot snapshot;
+    takeSnapshot(snapshot);
+    return hashSnapshot(snapshot);
+}
+
+// puts the world back to the tick snapshot was taken on
+void StudentWorld::restoreSnapshot(const WorldSnapshot& snapshot) {
+    // a snapshot of another level brings its robot speed with it
+    if (robotPeriod != robotPeriodFor(snapshot.level)) {
+        robotPeriod = robotPeriodFor(snapshot.level);
+        robotWheel.reset(robotPeriod);
+    }
+    tick = snapshot.tick; // robots are scheduled from it
+    restoreActors(snapshot);
+    bonus = snapshot.bonus;
+    crystalsLeft = snapshot.crystalsLeft;
+    finishLevel = snapshot.finishLevel;
+    rng = snapshot.rng;
+    
+    // exits are rebuilt hidden
+    if (crystalsLeft == 0)
+        revealExits();
+    updateActiveRegion(true);
+}
+
+// rebuilds every actor from its record in the same pool slot, in memory the pools already own
+// each one still goes through its constructor, so GraphObject registers it in the framework's set again
+void StudentWorld::restoreActors(const WorldSnapshot& snapshot) {
+    cleanUp();
+    
+    for (const ActorRecord& rec : snapshot.actors) {
+        double x = rec.x;
+        double y = rec.y;
+        Actor* actor = nullptr;
+        
+        switch (rec.type) {
+            case SNAP_AVATAR:
+                m_avatar = avatars.create(this, x, y);
+                m_avatar->setHealth(rec.health);
+                m_avatar->setAmmo(rec.ammo);
+                actor = m_avatar;
+                break;
+            case SNAP_WALL:
+                actor = walls.createAt(rec.slot, this, x, y);
+                break;
+            case SNAP_EXIT:
+                actor = exits.createAt(rec.slot, this, x, y);
+                break;
+            case SNAP_PIT:
+                actor = pits.createAt(rec.slot, this, x, y);
+                break;
+            case SNAP_CRYSTAL:
+                actor = crystals.createAt(rec.slot, this, x, y);
+                break;
+            case SNAP_RESTORE_HEALTH:
+                actor = restoreHealthGoodies.createAt(rec.slot, this, x, y);
+                break;
+            case SNAP_EXTRA_LIFE:
+                actor = extraLifeGoodies.createAt(rec.slot, this, x, y);
+                break;
+            case SNAP_AMMO:
+                actor = ammoGoodies.createAt(rec.slot, this, x, y);
+                break;
+            case SNAP_MARBLE: {
+                Marble* marble = marbles.createAt(rec.slot, this, x, y);
+                marble->setHitPoints(rec.health);
+                actor = marble;
+                break;
+            }
+            case SNAP_FACTORY:
+                actor = factories.createAt(rec.slot, this, x, y, (rec.flags & SNAP_MEAN) != 0);
+                break;
+            case SNAP_RAGEBOT: {
+                RageBot* bot = rageBots.createAt(rec.slot, this, x, y, rec.direction);
+                bot->setHealth(rec.health);
+                actor = bot;
+                break;
+            }
+            case SNAP_REGULAR_THIEFBOT:
+            case SNAP_MEAN_THIEFBOT: {
+                ThiefBot* bot;
+                if (rec.type == SNAP_REGULAR_THIEFBOT)
+                    bot = regularThiefBots.createAt(rec.slot, this, x, y);
+                else
+                    bot = meanThiefBots.createAt(rec.slot, this, x, y);
+                bot->setHealth(rec.health);
+                bot->setDistances(rec.distanceMoved, rec.maxDistance);
+                actor = bot;
+                break;
+            }
+            case SNAP_PEA: {
+                actor = firePea(cellAt(rec.x, rec.y), rec.direction);
+                if (!(rec.flags & SNAP_ALIVE))
+                    peas.lanes().alive.back() = false; // the pea itself is killed below like any other actor
+                break;
+            }
+        }
+        
+        actor->setDirection(rec.direction);
+        if (actor != m_avatar)
+            actor->setId(rec.id); // before the status, so a dead actor still gets removed
+        if (!(rec.flags & SNAP_ALIVE)) {
+            actor->updateStatus(false);
+            actor->setVisible(false);
+        }
+        if (!(rec.flags & SNAP_DETECTABLE)) {
+            actor->setUndetectable();
+            actor->setVisible(false);
+        }
+        if (actor != m_avatar) {
+            actor->setHandle(handles.add(actor));
+            insertIntoCell(actor, actor->getCell());
+            if (actor->hasTrait(TRAIT_TIMED) && actor->getStatus())
+                scheduleRobot(actor, tick);
+            if (rec.type == SNAP_MARBLE && rec.health <= 0 && actor->getStatus())
+                brokenMarbles.push_back(actor->getHandle());
+        }
+    }
+    nextActorId = snapshot.nextActorId;
+    
+    // thiefbots pick their goodies back up, both are in the same cell
+    for (const ActorRecord& rec : snapshot.actors) {
+        if (rec.goodieId == 0)
+            continue;
+        Cell cell = cellAt(rec.x, rec.y);
+        ThiefBot* bot = static_cast<ThiefBot*>(findInCell(cell, rec.id));
+        bot->gotGoodie();
+        bot->setGoodie(findInCell(cell, rec.goodieId));
+    }
+}
+
+// finds the actor with a given id in one cell
+Actor* StudentWorld::findInCell(Cell cell, unsigned int id) {
+    if (cell == NO_CELL)
+        return nullptr;
+    
+    const vector<Actor*>& actors = cells.actorsAt(cell);
+    for (size_t i = 0; i < actors.size(); i++) {
+        if (actors[i]->getId() == id)
+            return actors[i];
+    }
+    return nullptr;
+}
+
+/* ///////////////// OCCUPANCY GRID /////////////////*/
+
+
+// gives a newly created actor its id + handle, adds it to the grid and schedules robots
+void StudentWorld::addActor(Actor* actor) {
+    actor->setId(nextActorId++);
+    actor->setHandle(handles.add(actor));
+    insertIntoCell(actor, actor->getCell());
+    if (actor->hasTrait(TRAIT_TIMED))
+        scheduleRobot(actor, tick);
+}
+
+// removes everything that died this tick in one pass over the dead actors
+// the image id says which pool an actor came from
+void StudentWorld::removeDeadActors() {
+    if (tombstones.empty())
+        return;
+    PROFILE_SCOPE("removeDeadActors");
+    
+    bool peasDied = false;
+    for (size_t i = 0; i < tombstones.size(); i++) {
+        Actor* actor = tombstones[i];
+        removeFromCell(actor, actor->getCell());
+        handles.remove(actor->getHandle()); // anything still holding it now gets nullptr
+        actor->setHandle(NO_HANDLE);
+        
+        switch (actor->getID()) {
+            case IID_WALL:
+                walls.destroy(static_cast<Wall*>(actor));
+                break;
+            case IID_EXIT:
+                exits.destroy(static_cast<Exit*>(actor));
+                break;
+            case IID_PIT:
+                pits.destroy(static_cast<Pit*>(actor));
+                break;
+            case IID_MARBLE:
+                marbles.destroy(static_cast<Marble*>(actor));
+                break;
+            case IID_CRYSTAL:
+                crystals.destroy(static_cast<Crystal*>(actor));
+                break;
+            case IID_RESTORE_HEALTH:
+                restoreHealthGoodies.destroy(static_cast<RestoreHealth*>(actor));
+                break;
+            case IID_EXTRA_LIFE:
+                extraLifeGoodies.destroy(static_cast<ExtraLife*>(actor));
+                break;
+            case IID_AMMO:
+                ammoGoodies.destroy(static_cast<Ammo*>(actor));
+                break;
+            case IID_ROBOT_FACTORY:
+                factories.destroy(static_cast<ThiefBotFactory*>(actor));
+                break;
+            case IID_RAGEBOT:
+                rageBots.destroy(static_cast<RageBot*>(actor));
+                break;
+            case IID_THIEFBOT:
+                regularThiefBots.destroy(static_cast<RegularThiefBot*>(actor));
+                break;
+            case IID_MEAN_THIEFBOT:
+                meanThiefBots.destroy(static_cast<MeanThiefBot*>(actor));
+                break;
+            case IID_PEA:
+                peasDied = true; // recycled below so the pool keeps its firing order
+                break;
+        }
+    }
+    tombstones.clear();
+    
+    if (peasDied)
+        peas.removeDead();
+}
+
+// keeps each cell sorted by id so queries see actors in the order they were added
+void StudentWorld::insertIntoCell(Actor* actor, Cell cell) {
+    if (cell == NO_CELL)
+        return;
+    
+    WorldChunk& chunk = cells.get(cells.chunkOf(cell));
+    vector<Actor*>& actors = chunk.actors[ChunkGrid::squareOf(cell)];
+    auto pos = actors.begin();
+    while (pos != actors.end() && (*pos)->getId() < actor->getId())
+        pos++;
+    actors.insert(pos, actor);
+    
+    if (actor->hasTrait(TRAIT_FACTORY))
+        chunk.factories.push_back(actor);
+    if (actor->hasTrait(TRAIT_PEA_HIT))
+        updateBlockers(cell, 1);
+    if (actor->hasTrait(TRAIT_THIEFBOT))
+        updateNearbyThiefBots(cell, 1);
+    if (actor->hasTrait(TRAIT_TERRAIN))
+        updateTerrain(cell, 1);
+}
+
+void StudentWorld::removeFromCell(Actor* actor, Cell cell) {
+    if (cell == NO_CELL)
+        return;
+    
+    WorldChunk& chunk = cells.get(cells.chunkOf(cell));
+    vector<Actor*>& actors = chunk.actors[ChunkGrid::squareOf(cell)];
+    auto pos = find(actors.begin(), actors.end(), actor);
+    if (pos == actors.end())
+        return;
+    actors.erase(pos);
+    
+    if (actor->hasTrait(TRAIT_FACTORY))
+        chunk.factories.erase(find(chunk.factories.begin(), chunk.factories.end(), actor));
+    if (actor->hasTrait(TRAIT_PEA_HIT))
+        updateBlockers(cell, -1);
+    if (actor->hasTrait(TRAIT_THIEFBOT))
+        updateNearbyThiefBots(cell, -1);
+    if (actor->hasTrait(TRAIT_TERRAIN))
+        updateTerrain(cell, -1);
+}
+
+// keeps the row/column masks in sync with the blocker count of a cell
+void StudentWorld::updateBlockers(Cell cell, int change) {
+    int col = cellX(cell);
+    int row = cellY(cell);
+    int& count = cells.get(cells.chunkOf(cell)).blockerCount[ChunkGrid::squareOf(cell)];
+    count += change;
+    
+    unsigned long long rowBit = 1ULL << (col % 64);
+    unsigned long long colBit = 1ULL << (row % 64);
+    if (count > 0) {
+        rowBlockers[row][col / 64] |= rowBit;
+        colBlockers[col][row / 64] |= colBit;
+    }
+    else {
+        rowBlockers[row][col / 64] &= ~rowBit;
+        colBlockers[col][row / 64] &= ~colBit;
+    }
+}
+
+// terrain changes the seeking robots' paths, but only when a square goes from clear to blocked or back
+void StudentWorld::updateTerrain(Cell cell, int change) {
+    int& count = cells.get(cells.chunkOf(cell)).terrainCount[ChunkGrid::squareOf(cell)];
+    if ((count == 0) != (count + change == 0))
+        terrainVersion++;
+    count += change;
+}
+
+// a thiefbot in cell counts for every cell within 2 squares of it
+void StudentWorld::updateNearbyThiefBots(Cell cell, int change) {
+    int x = cellX(cell);
+    int y = cellY(cell);
+    for (int ny = max(0, y - 2); ny <= min(worldHeight - 1, y + 2); ny++) {
+        for (int nx = max(0, x - 2); nx <= min(worldWidth - 1, x + 2); nx++) {
+            Cell near = cellAt(nx, ny);
+            cells.get(cells.chunkOf(near)).nearbyThiefBots[ChunkGrid::squareOf(near)] += change;
+        }
+    }
+}
+
+// called by Avatar::avatarMove once the avatar is in its new square
+void StudentWorld::avatarEnteredCell(Cell cell) {
+    if (cell == NO_CELL)
+        return;
+    
+    // nothing reacting here removes itself from the cell before the end of the tick
+    const vector<Actor*>& actors = cells.actorsAt(cell);
+    for (size_t i = 0; i < actors.size(); i++) {
+        if (actors[i]->hasTrait(TRAIT_ON_ENTER))
+            actors[i]->avatarEntered();
+    }
+}
+
+// called by Actor::moveTo before the actor's position changes
+void StudentWorld::updateOccupancy(Actor* actor, Cell oldCell, Cell newCell) {
+    if (actor->getId() == 0) // avatar isn't kept in the grid
+        return;
+    if (oldCell == newCell)
+        return;
+    
+    removeFromCell(actor, oldCell);
+    insertIntoCell(actor, newCell);
+}
@@ -4,13 +4,35 @@
 #include "GameWorld.h"
 #include "GraphObject.h"
 #include "Level.h"
+#include "Actor.h"
+#include "ActorPool.h"
+#include "PeaPool.h"
+#include "Random.h"
+#include "InputSource.h"
+#include "LevelData.h"
+#include "WorldSnapshot.h"
+#include "StatusLine.h"
+#include "Cell.h"
+#include "ChunkGrid.h"
+#include "ActorHandle.h"
+#include "EffectBuffer.h"
+#include "WorkerGroup.h"
+#include "TimingWheel.h"
+#include "Replay.h"
+#include "MazeGenerator.h"
+#include "DistanceField.h"
 #include <string>
-#include <list>
-#include <iomanip>
+#include <vector>
+#include <memory>
 using namespace std;
 
-class Actor;
-class Avatar;
+const int ACTIVE_REGION_RADIUS = 2; // chunks simulated on each side of the avatar's, well past the view
+
+// what a seeking robot heads for, each has its own distance field
+enum NavigationTarget {
+    NAVIGATE_TO_GOODIE, // nearest goodie no thiefbot is carrying
+    NAVIGATE_TO_PLAYER
+};
 
 class StudentWorld : public GameWorld
 {
@@ -27,11 +49,57 @@ public:
     // helper functions
     void updateDisplayText();
     
+    // headless mode: no sound or status text, input comes from an InputSource
+    void setHeadless(bool headless) { m_headless = headless; }
+    bool isHeadless() const { return m_headless; }
+    void setInputSource(InputSource* input) { m_input = input; }
+    bool getPlayerKey(int& ch);
+    
+    // sounds + score are queued and applied at the end of the tick
+    void playSound(int soundID) { if (!m_headless) effects.playSound(soundID); }
+    void increaseScore(unsigned int howMuch) { effects.increaseScore(howMuch); }
+    
+    // random numbers come from the world's own generator instead of rand()
+    void setSeed(uint64_t seed) { rng.setSeed(seed); }
+    int randInt(int min, int max) { return rng.randInt(min, max); }
+    RandomGenerator& getRandom() { return rng; }
+    
+    // 0 updates actors one after another, n > 0 plans robots + factories on n threads first (see Intent.h)
+    void setParallelUpdate(int numThreads);
+    
+    // cells are packed by chunk, see Cell.h + ChunkGrid.h
+    Cell cellAt(int x, int y) const {
+        if (x < 0 || x >= worldWidth || y < 0 || y >= worldHeight)
+            return NO_CELL;
+        return cells.pack(x, y);
+    }
+    int cellX(Cell cell) const { return cells.cellX(cell); }
+    int cellY(Cell cell) const { return cells.cellY(cell); }
+    Cell neighborCell(Cell cell, int dir) const;
+    int getWorldWidth() const { return worldWidth; }
+    int getWorldHeight() const { return worldHeight; }
+    
+    // robots + factories only run within radius chunks of the avatar's chunk, negative runs all of them
+    void setActiveRadius(int radius);
+    int getAllocatedChunks() const { return cells.allocatedChunks(); }
+    
+    // off: thiefbots wander + ragebots pace back and forth, like the original game
+    // on: thiefbots head for the nearest goodie + ragebots for the player (see DistanceField.h)
+    // setting MM_SEEKING_ROBOTS turns it on for the interactive game, replays record which one was used
+    void setSeekingRobots(bool seek) { seekingRobots = seek; }
+    bool isSeekingRobots() const { return seekingRobots; }
+    int stepToward(const Actor* robot, NavigationTarget target) const;
+    
     // accessor functions
-    Actor* getActorAtPos(double x, double y);
+    Actor* getActorAtPos(Cell cell);
     int getTick() { return tick; }
     int getCurrLevel() { return getLevel(); }
     int getPlayerDirection(); 
+    int getActorCount() const; // every actor except the avatar
+    int getPeaCount() const { return peas.size(); }
+    const Avatar* getAvatar() const { return m_avatar; } // nullptr if no level is loaded
+    unsigned int getBonus() const { return bonus; }
+    const vector<Actor*>& actorsAt(Cell cell) const { return cells.actorsAt(cell); } // in id order, not the avatar
     
     // goodie functions
     void restoreHealth();
@@ -41,34 +109,153 @@ public:
     // crystal functions
     void foundCrystal();
     int numCrystals() const { return crystalsLeft; }
+    void revealExits();
     void levelCompleted() { finishLevel = true; playSound(SOUND_FINISHED_LEVEL); }
     
+    // marble functions
+    void marbleBroke(Marble* marble) { brokenMarbles.push_back(marble->getHandle()); }
+    
     // pea related functions
-    void constructPea(double x, double y, int direction);
-    int overlapPea(double x, double y);
+    void constructPea(Cell cell, int direction);
+    int overlapPea(Cell cell);
+    int peaHighWaterMark() const { return peas.highWaterMark(); }
     
     // marble related functions
-    bool canMarbleMove(Actor* actor, double x, double y);
-    bool canRobotMove(Actor* actor, double x, double y) const;
+    bool canMarbleMove(Actor* actor, Cell cell);
+    bool canRobotMove(Cell cell) const;
     void killMarble();
     
     // movement functions
-    bool isInBounds(double x, double y);
-    bool onSameSquareAsPlayer(double x, double y);
-    bool sameRowColAsPlayer(double x, double y, int dir);
+    bool isInBounds(Cell cell);
+    bool onSameSquareAsPlayer(Cell cell) const { return m_avatar->getCell() == cell; }
+    bool sameRowColAsPlayer(Cell cell, int dir);
     
     // robot related functions
-    bool robotCanShootPlayer(double x, double y, int dir);
-    bool onSameSquareAsGoodie(double x, double y);
-    int countSurroundingThiefBots(double x, double y);
-    void constructMeanThiefBot(double x, double y);
-    void constructRegularThiefBot(double x, double y);
-    bool onSameSquareAsThiefBot(double x, double y);
+    bool robotCanShootPlayer(Cell cell, int dir);
+    bool onSameSquareAsGoodie(Cell cell);
+    int countSurroundingThiefBots(Cell cell);
+    void constructMeanThiefBot(Cell cell);
+    void constructRegularThiefBot(Cell cell);
+    bool onSameSquareAsThiefBot(Cell cell);
+    
+    // snapshot functions
+    void takeSnapshot(WorldSnapshot& snapshot);
+    void restoreSnapshot(const WorldSnapshot& snapshot);
+    uint64_t stateHash(); // 0 if no level is loaded
+    
+    // plays maze instead of the level files, nullptr goes back to the files
+    // the world only keeps the pointer, so maze has to outlive it
+    void setMaze(const Maze* maze) { m_maze = maze; loadedLevel = -1; }
+    
+    // records every level from its start into a replay (see Replay.h)
+    void setRecorder(ReplayRecorder* recorder) { m_recorder = recorder; }
+    
+    // MM_RECORD_DIR records the game into that directory and MM_SEEKING_ROBOTS turns on seeking robots,
+    // only read for the world the framework makes
+    void readEnvironment();
+    
+    // occupancy grid functions
+    void updateOccupancy(Actor* actor, Cell oldCell, Cell newCell);
+    void avatarEnteredCell(Cell cell); // crystals, goodies + exits react instead of checking every tick
+    
+    // handles + removal
+    Actor* getActor(ActorHandle handle) const { return handles.get(handle); }
+    void actorDied(Actor* actor) { tombstones.push_back(actor); }
     
 private:
-    list<Actor*> actorList;
+    Level::LoadResult loadLevelData();
+    void resizeWorld(int width, int height);
+    void restoreActors(const WorldSnapshot& snapshot);
+    Actor* findInCell(Cell cell, unsigned int id);
+    void addActor(Actor* actor);
+    void applyEffects();
+    Pea* firePea(Cell cell, int direction);
+    bool advancePeas();
+    void scheduleRobot(Actor* robot, int after);
+    bool isChunkActive(int chunk) const;
+    void updateActiveRegion(bool force);
+    void wakeRobots();
+    void rescheduleRobots();
+    void updateNavigation();
+    void updateRobotsInParallel();
+    void endRecording();
+    void removeDeadActors();
+    void insertIntoCell(Actor* actor, Cell cell);
+    void removeFromCell(Actor* actor, Cell cell);
+    void updateBlockers(Cell cell, int change);
+    void updateNearbyThiefBots(Cell cell, int change);
+    void updateTerrain(Cell cell, int change);
+    
+    LevelData levelData; // maze of the level in loadedLevel
+    int loadedLevel;
+    WorldSnapshot startSnapshot; // loadedLevel right after it was built
+    bool haveStartSnapshot;
+    
+    // each concrete actor type lives in its own pool
+    ActorPool<Avatar> avatars; // only ever holds m_avatar
+    ActorPool<Wall> walls;
+    ActorPool<Exit> exits;
+    ActorPool<Pit> pits;
+    ActorPool<Marble> marbles;
+    ActorPool<Crystal> crystals;
+    ActorPool<RestoreHealth> restoreHealthGoodies;
+    ActorPool<ExtraLife> extraLifeGoodies;
+    ActorPool<Ammo> ammoGoodies;
+    ActorPool<ThiefBotFactory> factories;
+    ActorPool<RageBot> rageBots;
+    ActorPool<RegularThiefBot> regularThiefBots;
+    ActorPool<MeanThiefBot> meanThiefBots;
+    PeaPool peas; // recycled, never freed until the world is destroyed
+    vector<int> peaNextX; // where each pea moves to this tick, filled by PeaPool::step
+    vector<int> peaNextY;
+    
+    int worldWidth; // size of the world in cells
+    int worldHeight;
+    ChunkGrid cells; // actors + per-cell counts, a chunk at a time
+    unsigned int nextActorId;
+    HandleTable handles; // every actor except the avatar
+    EffectBuffer effects; // sounds, score and spawns asked for this tick
+    
+    // robots act once every robotPeriod ticks, they sleep in the wheel in between
+    TimingWheel robotWheel;
+    int robotPeriod;
+    vector<ActorHandle> dueHandles;
+    vector<Actor*> dueRobots; // robots acting this tick, in id order
+    vector<ActorHandle> brokenMarbles; // out of hit points, they break on their next turn
+    
+    // chunks within activeRadius of (activeX, activeY) are simulated, the rest sleep
+    int activeRadius;
+    int activeX;
+    int activeY;
+    vector<Actor*> activeFactories; // factories in the active region, in id order
+    
+    // seeking robots steer by the fields, built over the active region once per tick at most
+    bool seekingRobots;
+    uint64_t terrainVersion; // goes up whenever a square gains its first terrain actor or loses its last
+    DistanceField goodieField;
+    DistanceField playerField;
+    vector<pair<int, int>> navTargets;
+    
+    // parallel update, nullptr when actors update one after another
+    unique_ptr<WorkerGroup> workers;
+    vector<Actor*> planners; // active factories + robots due this tick in update order
+    vector<Intent> intents; // planners[i] wants intents[i]
+    vector<Actor*> tombstones; // actors that died this tick, removed at the end of it
+    
+    // line of sight masks: bit set if a pea-blocking actor is in that cell
+    vector<vector<unsigned long long>> rowBlockers; // one mask per row, bit x
+    vector<vector<unsigned long long>> colBlockers; // one mask per column, bit y
     Avatar* m_avatar;
     
+    RandomGenerator rng;
+    InputSource* m_input; // nullptr means read the keyboard
+    ReplayRecorder* m_recorder; // nullptr when not recording
+    const Maze* m_maze; // generated maze played on every level, nullptr when loading files
+    unique_ptr<ReplayRecorder> envRecorder; // made from MM_RECORD_DIR
+    bool m_headless;
+    
+    StatusLine statusLine;
+    
     bool finishLevel;
     int crystalsLeft;
     unsigned int bonus;
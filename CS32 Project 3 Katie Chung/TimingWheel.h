@@ -0,0 +1,65 @@
+#ifndef TIMINGWHEEL_H_
+#define TIMINGWHEEL_H_
+
+#include "ActorHandle.h"
+#include <vector>
+using namespace std;
+
+/*
+ Wakes actors up on the tick they next act on.
+
+ The wheel has one bucket per tick, reused every size() ticks, so an actor
+ can be scheduled at most size() - 1 ticks ahead. Each bucket is kept in
+ actor id order, which makes the wake-up order the same no matter how the
+ bucket was filled (including after a snapshot is restored). Entries are
+ handles, so an actor that dies while it waits just stops resolving.
+ */
+
+class TimingWheel {
+public:
+    TimingWheel() : m_mask(0) {}
+
+    // room to schedule up to maxDelay ticks ahead, empties the wheel
+    void reset(int maxDelay) {
+        int size = 1;
+        while (size <= maxDelay)
+            size *= 2;
+        m_buckets.assign(size, vector<Entry>());
+        m_mask = size - 1;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < m_buckets.size(); i++)
+            m_buckets[i].clear();
+    }
+
+    void schedule(unsigned int id, ActorHandle handle, int tick) {
+        vector<Entry>& bucket = m_buckets[tick & m_mask];
+        size_t pos = bucket.size();
+        while (pos > 0 && bucket[pos - 1].id > id) // almost always appends
+            pos--;
+        bucket.insert(bucket.begin() + pos, Entry { id, handle });
+    }
+
+    // moves the handles due on tick into due, in id order
+    void takeDue(int tick, vector<ActorHandle>& due) {
+        vector<Entry>& bucket = m_buckets[tick & m_mask];
+        due.clear();
+        for (size_t i = 0; i < bucket.size(); i++)
+            due.push_back(bucket[i].handle);
+        bucket.clear();
+    }
+
+    int size() const { return m_buckets.size(); }
+
+private:
+    struct Entry {
+        unsigned int id;
+        ActorHandle handle;
+    };
+
+    vector<vector<Entry>> m_buckets;
+    int m_mask;
+};
+
+#endif // TIMINGWHEEL_H_
@@ -0,0 +1,68 @@
+// EnvBenchmark.cpp
+//
+// Measures how many environment steps per second a GameEnv (see GameEnv.h)
+// gets through with random actions, in total and per thread, and how much
+// reward and how many finished episodes came out of it.
+//
+// Build from the project directory together with the game sources (minus the
+// framework's main.cpp), e.g.
+//     g++ -std=c++17 -O2 -pthread -I. -I<framework dir> Tools/EnvBenchmark.cpp GameEnv.cpp StudentWorld.cpp Actor.cpp HeadlessDriver.cpp LevelData.cpp StatusLine.cpp WorkerGroup.cpp Profiler.cpp Replay.cpp MazeGenerator.cpp <framework sources> -o env_benchmark
+// Usage:
+//     env_benchmark <asset dir> [environments] [steps] [threads] [level] [seed]
+// steps counts batch steps, so the environment steps are steps * environments.
+
+#include "GameEnv.h"
+#include "Random.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <asset dir> [environments] [steps] [threads] [level] [seed]\n", argv[0]);
+        return 1;
+    }
+    string assetDir = argv[1];
+    int numEnvs = argc > 2 ? atoi(argv[2]) : 64;
+    int steps = argc > 3 ? atoi(argv[3]) : 10000;
+    int threads = argc > 4 ? atoi(argv[4]) : 1;
+    int level = argc > 5 ? atoi(argv[5]) : 1;
+    uint64_t seed = argc > 6 ? strtoull(argv[6], nullptr, 10) : 1;
+    if (numEnvs <= 0 || steps <= 0) {
+        fprintf(stderr, "environments and steps must be positive\n");
+        return 1;
+    }
+
+    GameEnv env(assetDir, numEnvs, threads);
+    if (!env.reset(seed, level)) {
+        fprintf(stderr, "level%02d could not be loaded\n", level);
+        return 1;
+    }
+
+    RandomGenerator rng(seed);
+    vector<int> actions(numEnvs);
+    double totalReward = 0;
+    long long episodes = 0;
+
+    auto begin = chrono::steady_clock::now();
+    for (int s = 0; s < steps; s++) {
+        for (int i = 0; i < numEnvs; i++)
+            actions[i] = rng.randInt(0, ENV_NUM_ACTIONS - 1);
+        env.step(actions.data());
+        for (int i = 0; i < numEnvs; i++) {
+            totalReward += env.rewards()[i];
+            episodes += env.dones()[i];
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    double envSteps = double(steps) * numEnvs;
+    printf("level%02d  %d envs  %d threads  %.0f env steps/s  %.0f env steps/s per thread\n",
+           level, numEnvs, env.getThreadCount(), envSteps / seconds, envSteps / seconds / env.getThreadCount());
+    printf("         observation %d floats  reward %.0f  episodes finished %lld\n", OBS_SIZE, totalReward, episodes);
+    return 0;
+}
@@ -0,0 +1,58 @@
+// LevelCompiler.cpp
+//
+// Compiles text levels into the binary format StudentWorld::init() maps
+// straight into memory. Every levelNN.txt in the asset directory becomes a
+// levelNN.bin next to it (or in the output directory, if one is given).
+// Once a .bin file exists the game loads it instead of the .txt file, so
+// recompile after editing a level.
+//
+// Build from the project directory with LevelData.cpp and the framework's
+// Level sources, e.g.
+//     g++ -std=c++17 -O2 -I. -I<framework dir> Tools/LevelCompiler.cpp LevelData.cpp -o level_compiler
+// Usage:
+//     level_compiler <asset dir> [output dir]
+
+#include "LevelData.h"
+#include <cstdio>
+#include <string>
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <asset dir> [output dir]\n", argv[0]);
+        return 1;
+    }
+    string assetDir = argv[1];
+    string outDir = argc > 2 ? argv[2] : assetDir;
+    
+    int compiled = 0;
+    int failed = 0;
+    for (int level = 0; level <= 99; level++) {
+        char name[16];
+        snprintf(name, sizeof(name), "level%02d", level);
+        
+        LevelData data;
+        Level::LoadResult result = data.loadText(assetDir, string(name) + ".txt");
+        if (result == Level::load_fail_file_not_found)
+            continue;
+        if (result == Level::load_fail_bad_format) {
+            fprintf(stderr, "%s.txt: not formatted correctly\n", name);
+            failed++;
+            continue;
+        }
+        
+        string outPath = outDir + "/" + name + ".bin";
+        if (!data.saveCompiled(outPath)) {
+            fprintf(stderr, "%s: could not write\n", outPath.c_str());
+            failed++;
+            continue;
+        }
+        printf("%s.txt -> %s (%dx%d, %d crystals)\n", name, outPath.c_str(),
+               data.getWidth(), data.getHeight(), data.getCrystals());
+        compiled++;
+    }
+    
+    printf("%d compiled, %d failed\n", compiled, failed);
+    return failed == 0 ? 0 : 1;
+}
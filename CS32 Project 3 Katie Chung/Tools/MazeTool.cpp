@@ -0,0 +1,93 @@
+// MazeTool.cpp
+//
+// Writes a random maze (see MazeGenerator.h) for stress tests. A path ending
+// in .bin gets a compiled level of any size. Anything else gets the levelNN.txt
+// text format, which the game can only read back when the maze is the size of
+// the view.
+//
+// Build from the project directory with LevelData.cpp, MazeGenerator.cpp and
+// the framework's Level sources, e.g.
+//     g++ -std=c++17 -O2 -I. -I<framework dir> Tools/MazeTool.cpp MazeGenerator.cpp LevelData.cpp -o maze_tool
+// Usage:
+//     maze_tool <out file> [--size WxH] [--walls density] [--crystals n]
+//               [--factories n] [--mean-factories n] [--ragebots n]
+//               [--marbles n] [--pits n] [--goodies n] [--seed n]
+// e.g. maze_tool assets/level97.bin --size 1024x1024 --ragebots 20000 --mean-factories 2000
+
+#include "MazeGenerator.h"
+#include "LevelData.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+using namespace std;
+
+static bool endsWith(const string& text, const string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static int usage(const char* program) {
+    fprintf(stderr, "usage: %s <out file> [--size WxH] [--walls density] [--crystals n] [--factories n]\n", program);
+    fprintf(stderr, "       [--mean-factories n] [--ragebots n] [--marbles n] [--pits n] [--goodies n] [--seed n]\n");
+    return 1;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc % 2 != 0)
+        return usage(argv[0]);
+    string outPath = argv[1];
+
+    MazeParams params;
+    for (int i = 2; i < argc; i += 2) {
+        const char* name = argv[i];
+        const char* value = argv[i + 1];
+        if (strcmp(name, "--size") == 0) {
+            if (sscanf(value, "%dx%d", &params.width, &params.height) != 2)
+                return usage(argv[0]);
+        }
+        else if (strcmp(name, "--walls") == 0)
+            params.wallDensity = atof(value);
+        else if (strcmp(name, "--crystals") == 0)
+            params.crystals = atoi(value);
+        else if (strcmp(name, "--factories") == 0)
+            params.factories = atoi(value);
+        else if (strcmp(name, "--mean-factories") == 0)
+            params.meanFactories = atoi(value);
+        else if (strcmp(name, "--ragebots") == 0)
+            params.rageBots = atoi(value);
+        else if (strcmp(name, "--marbles") == 0)
+            params.marbles = atoi(value);
+        else if (strcmp(name, "--pits") == 0)
+            params.pits = atoi(value);
+        else if (strcmp(name, "--goodies") == 0)
+            params.goodies = atoi(value);
+        else if (strcmp(name, "--seed") == 0)
+            params.seed = strtoull(value, nullptr, 10);
+        else
+            return usage(argv[0]);
+    }
+    if (params.width > MAX_LEVEL_SIZE || params.height > MAX_LEVEL_SIZE) {
+        fprintf(stderr, "mazes can be at most %d squares on a side\n", MAX_LEVEL_SIZE);
+        return 1;
+    }
+
+    Maze maze = generateMaze(params);
+    LevelData data;
+    data.loadCells(maze.width, maze.height, maze.cells);
+
+    bool written = endsWith(outPath, ".bin") ? data.saveCompiled(outPath) : saveMazeText(outPath, maze);
+    if (!written) {
+        fprintf(stderr, "%s: could not write\n", outPath.c_str());
+        return 1;
+    }
+
+    // placement stops early when it runs out of squares, so report what went in
+    printf("%s (%dx%d): %d walls, %d crystals, %d + %d factories, %d ragebots, %d marbles, %d pits, %d goodies\n",
+           outPath.c_str(), maze.width, maze.height, data.getCount(Level::wall), data.getCrystals(),
+           data.getCount(Level::thiefbot_factory), data.getCount(Level::mean_thiefbot_factory),
+           data.getCount(Level::horiz_ragebot) + data.getCount(Level::vert_ragebot),
+           data.getCount(Level::marble), data.getCount(Level::pit),
+           data.getCount(Level::extra_life) + data.getCount(Level::restore_health) + data.getCount(Level::ammo));
+    return 0;
+}
@@ -0,0 +1,100 @@
+// ReplayTool.cpp
+//
+// Records and checks .mmr replays (see Replay.h).
+//
+//     replay_tool check <asset dir> <replay file>...
+// plays every replay back headless as fast as it will go and checks that the
+// ticks, score, lives and final state hash match the recording. Exits with 1
+// if any replay doesn't match, so a folder of replays works as a regression
+// suite. Replays of real games come from running the game with MM_RECORD_DIR
+// set.
+//
+//     replay_tool record <asset dir> <out dir> <level> <seed> [ticks] [seek]
+// plays a level headless with random key presses and records it, for making
+// replays without sitting down to play. seek 1 turns on the seeking robots,
+// which the replay remembers.
+//
+// Build from the project directory together with the game sources (minus the
+// framework's main.cpp), e.g.
+//     g++ -std=c++17 -O2 -pthread -I. -I<framework dir> Tools/ReplayTool.cpp Replay.cpp StudentWorld.cpp Actor.cpp HeadlessDriver.cpp LevelData.cpp StatusLine.cpp WorkerGroup.cpp Profiler.cpp MazeGenerator.cpp <framework sources> -o replay_tool
+
+#include "Replay.h"
+#include "HeadlessDriver.h"
+#include "InputSource.h"
+#include "Random.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <cstring>
+using namespace std;
+
+static int check(const string& assetDir, int count, char* files[]) {
+    int failed = 0;
+    for (int i = 0; i < count; i++) {
+        Replay replay;
+        if (!loadReplay(files[i], replay)) {
+            printf("%s  could not be read\n", files[i]);
+            failed++;
+            continue;
+        }
+
+        auto start = chrono::steady_clock::now();
+        ReplayCheck result = playReplay(assetDir, replay);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        const ReplayHeader& h = replay.header;
+        if (result.matches) {
+            printf("%s  ok  level%02d  %d ticks  %.0f ticks/s\n", files[i], h.level, h.ticks, result.ticks / seconds);
+        }
+        else {
+            printf("%s  MISMATCH  level%02d\n", files[i], h.level);
+            printf("    recorded: ticks %d  score %u  lives %d  hash %016llx\n",
+                   h.ticks, h.scoreGained, h.endLives, (unsigned long long)h.stateHash);
+            printf("    played:   ticks %d  score %u  lives %d  hash %016llx\n",
+                   result.ticks, result.score, result.lives, (unsigned long long)result.stateHash);
+            failed++;
+        }
+    }
+    printf("%d of %d replays match\n", count - failed, count);
+    return failed == 0 ? 0 : 1;
+}
+
+static int record(const string& assetDir, const string& outDir, int level, uint64_t seed, int ticks, bool seeking) {
+    static const int keys[] = { KEY_PRESS_LEFT, KEY_PRESS_RIGHT, KEY_PRESS_UP, KEY_PRESS_DOWN, KEY_PRESS_SPACE, 0 };
+    RandomGenerator rng(seed);
+    vector<int> script;
+    for (int i = 0; i < ticks; i++)
+        script.push_back(keys[rng.randInt(0, 5)]);
+
+    ScriptedInput input(script);
+    ReplayRecorder recorder(outDir);
+    {
+        HeadlessDriver driver(assetDir, level, seed, &input);
+        driver.getWorld()->setRecorder(&recorder);
+        driver.getWorld()->setSeekingRobots(seeking);
+        driver.run(ticks);
+    } // the world writes a level it didn't finish when it is destroyed
+
+    if (recorder.getLastPath().empty()) {
+        fprintf(stderr, "level%02d could not be loaded\n", level);
+        return 1;
+    }
+    printf("wrote %s  (%d ticks in %zu runs)\n", recorder.getLastPath().c_str(),
+           recorder.getReplay().header.ticks, recorder.getReplay().runs.size());
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc >= 4 && strcmp(argv[1], "check") == 0)
+        return check(argv[2], argc - 3, argv + 3);
+    if (argc >= 6 && strcmp(argv[1], "record") == 0)
+        return record(argv[2], argv[3], atoi(argv[4]), strtoull(argv[5], nullptr, 10), argc > 6 ? atoi(argv[6]) : 5000,
+                      argc > 7 && atoi(argv[7]) != 0);
+
+    fprintf(stderr, "usage: %s check <asset dir> <replay file>...\n", argv[0]);
+    fprintf(stderr, "       %s record <asset dir> <out dir> <level> <seed> [ticks] [seek]\n", argv[0]);
+    return 1;
+}
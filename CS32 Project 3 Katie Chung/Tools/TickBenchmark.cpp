@@ -0,0 +1,239 @@
+// TickBenchmark.cpp
+//
+// Measures how fast StudentWorld::move() runs headless.
+//
+// For every levelNN.txt in the asset directory (plus two generated stress
+// mazes and a big random one from MazeGenerator) it runs TICKS ticks with a
+// fixed seed and scripted input, restarting the run whenever the game ends,
+// and prints ticks/sec, ns/tick percentiles and how many actors were alive
+// over time.
+//
+// Build from the project directory together with the game sources (minus the
+// framework's main.cpp), e.g.
+//     g++ -std=c++17 -O2 -pthread -I. -I<framework dir> Tools/TickBenchmark.cpp StudentWorld.cpp Actor.cpp HeadlessDriver.cpp LevelData.cpp StatusLine.cpp WorkerGroup.cpp Profiler.cpp Replay.cpp MazeGenerator.cpp <framework sources> -o tick_benchmark
+// Usage:
+//     tick_benchmark <asset dir> [ticks per level] [seed] [update threads] [seek]
+// update threads > 0 turns on the parallel robot update (see Intent.h)
+// seek 1 times the robots that steer by distance fields (see DistanceField.h)
+// instead of wandering.
+// Add -DMM_PROFILE (and Profiler.cpp) to also write tick_profile.csv and
+// tick_trace.json with the time per actor type and the world query counts.
+
+#include "HeadlessDriver.h"
+#include "InputSource.h"
+#include "Random.h"
+#include "Profiler.h"
+#include "MazeGenerator.h"
+#include "LevelData.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+// stress mazes are only labeled with these, they never touch the disk
+const int STRESS_FACTORY_LEVEL = 98;
+const int STRESS_PEA_LEVEL = 99;
+const int STRESS_BIG_LEVEL = 97;
+const int SAMPLE_EVERY = 100; // ticks between actor count samples
+
+// a maze where every free square is a mean thiefbot factory
+static vector<string> factoryStressMaze() {
+    vector<string> rows;
+    for (int y = 0; y < VIEW_HEIGHT; y++) {
+        string row;
+        for (int x = 0; x < VIEW_WIDTH; x++) {
+            if (x == 0 || y == 0 || x == VIEW_WIDTH - 1 || y == VIEW_HEIGHT - 1)
+                row += '#';
+            else if (x == 1 && y == 1)
+                row += '@';
+            else if (x == VIEW_WIDTH - 2 && y == VIEW_HEIGHT - 2)
+                row += '*';
+            else if ((x + y) % 2 == 0)
+                row += '2';
+            else
+                row += ' ';
+        }
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+// a maze full of ragebots lined up with open rows and columns to shoot along
+static vector<string> peaStressMaze() {
+    vector<string> rows;
+    for (int y = 0; y < VIEW_HEIGHT; y++) {
+        string row;
+        for (int x = 0; x < VIEW_WIDTH; x++) {
+            if (x == 0 || y == 0 || x == VIEW_WIDTH - 1 || y == VIEW_HEIGHT - 1)
+                row += '#';
+            else if (x == VIEW_WIDTH / 2 && y == VIEW_HEIGHT / 2)
+                row += '@';
+            else if (x == VIEW_WIDTH - 2 && y == 1)
+                row += '*';
+            else if (x % 3 == 1 && y % 3 == 1)
+                row += (x + y) % 2 == 0 ? 'h' : 'v';
+            else
+                row += ' ';
+        }
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+// rows in the levelNN.txt layout (top row first) as a Maze
+static Maze mazeFromRows(const vector<string>& rows) {
+    Maze maze;
+    maze.width = VIEW_WIDTH;
+    maze.height = VIEW_HEIGHT;
+    maze.cells.assign(maze.width * maze.height, Level::empty);
+    for (int y = 0; y < maze.height; y++) {
+        const string& row = rows[maze.height - 1 - y];
+        for (int x = 0; x < maze.width; x++) {
+            for (int entry = 0; entry < NUM_MAZE_ENTRIES; entry++) {
+                if (mazeEntryChar(Level::MazeEntry(entry)) == row[x])
+                    maze.cells[y * maze.width + x] = entry;
+            }
+        }
+    }
+    return maze;
+}
+
+static bool levelExists(const string& assetDir, int level) {
+    char name[32];
+    snprintf(name, sizeof(name), "level%02d.txt", level);
+    ifstream in(assetDir + "/" + name);
+    return bool(in);
+}
+
+// random key presses that keep the avatar moving and shooting
+static vector<int> makeScript(uint64_t seed, int length) {
+    static const int keys[] = { KEY_PRESS_LEFT, KEY_PRESS_RIGHT, KEY_PRESS_UP, KEY_PRESS_DOWN, KEY_PRESS_SPACE, 0 };
+    RandomGenerator rng(seed);
+    vector<int> script;
+    for (int i = 0; i < length; i++)
+        script.push_back(keys[rng.randInt(0, 5)]);
+    return script;
+}
+
+static long long percentile(const vector<long long>& sorted, double p) {
+    if (sorted.empty())
+        return 0;
+    size_t index = (size_t)(p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+// a large random maze crowded with robots + factories
+static MazeParams bigStressParams(uint64_t seed) {
+    MazeParams params;
+    params.width = 256;
+    params.height = 256;
+    params.wallDensity = 0.15;
+    params.crystals = 200;
+    params.factories = 300;
+    params.meanFactories = 300;
+    params.rageBots = 2000;
+    params.marbles = 500;
+    params.pits = 200;
+    params.goodies = 300;
+    params.seed = seed;
+    return params;
+}
+
+// runs ticks ticks of one level (or of maze instead, if there is one) + prints a report line
+static void benchmarkLevel(const string& assetDir, int level, int ticks, uint64_t seed, int updateThreads, bool seeking, const Maze* maze = nullptr) {
+    ScriptedInput input(makeScript(seed, 4096), true);
+    vector<long long> tickTimes;
+    tickTimes.reserve(ticks);
+    vector<int> actorSamples;
+    int restarts = 0;
+    int maxPeas = 0;
+    
+    HeadlessDriver* driver = new HeadlessDriver(assetDir, level, seed, &input);
+    driver->getWorld()->setParallelUpdate(updateThreads);
+    driver->getWorld()->setSeekingRobots(seeking);
+    driver->getWorld()->setMaze(maze);
+    if (driver->start() != GWSTATUS_CONTINUE_GAME) {
+        printf("level%02d  could not be loaded\n", level);
+        delete driver;
+        return;
+    }
+    
+    auto begin = chrono::steady_clock::now();
+    for (int t = 0; t < ticks; t++) {
+        if (driver->isDone()) { // game over or level finished, start a new run
+            delete driver;
+            driver = new HeadlessDriver(assetDir, level, seed + ++restarts, &input);
+            driver->getWorld()->setParallelUpdate(updateThreads);
+            driver->getWorld()->setSeekingRobots(seeking);
+            driver->getWorld()->setMaze(maze);
+            driver->start();
+        }
+        
+        auto start = chrono::steady_clock::now();
+        driver->step();
+        auto end = chrono::steady_clock::now();
+        tickTimes.push_back(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
+        
+        if (!driver->isDone()) {
+            maxPeas = max(maxPeas, driver->getWorld()->getPeaCount());
+            if (t % SAMPLE_EVERY == 0)
+                actorSamples.push_back(driver->getWorld()->getActorCount());
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    delete driver;
+    
+    sort(tickTimes.begin(), tickTimes.end());
+    printf("level%02d  %10.0f ticks/s  p50 %7lld ns  p90 %7lld ns  p99 %7lld ns  max %8lld ns  restarts %d  max peas %d\n",
+           level, ticks / seconds, percentile(tickTimes, 0.5), percentile(tickTimes, 0.9),
+           percentile(tickTimes, 0.99), tickTimes.back(), restarts, maxPeas);
+    
+    printf("         actors every %d ticks:", SAMPLE_EVERY);
+    for (size_t i = 0; i < actorSamples.size(); i++)
+        printf(" %d", actorSamples[i]);
+    printf("\n");
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <asset dir> [ticks per level] [seed] [update threads] [seek]\n", argv[0]);
+        return 1;
+    }
+    string assetDir = argv[1];
+    int ticks = argc > 2 ? atoi(argv[2]) : 10000;
+    uint64_t seed = argc > 3 ? strtoull(argv[3], nullptr, 10) : 1;
+    int updateThreads = argc > 4 ? atoi(argv[4]) : 0;
+    bool seeking = argc > 5 && atoi(argv[5]) != 0;
+    if (ticks <= 0) {
+        fprintf(stderr, "ticks per level must be positive\n");
+        return 1;
+    }
+    
+    for (int level = 0; level < STRESS_BIG_LEVEL; level++) {
+        if (levelExists(assetDir, level))
+            benchmarkLevel(assetDir, level, ticks, seed, updateThreads, seeking);
+    }
+    
+    // synthetic stress mazes are handed straight to the world, nothing is written to the asset directory
+    Maze factoryStress = mazeFromRows(factoryStressMaze());
+    Maze peaStress = mazeFromRows(peaStressMaze());
+    benchmarkLevel(assetDir, STRESS_FACTORY_LEVEL, ticks, seed, updateThreads, seeking, &factoryStress);
+    benchmarkLevel(assetDir, STRESS_PEA_LEVEL, ticks, seed, updateThreads, seeking, &peaStress);
+    
+    Maze big = generateMaze(bigStressParams(seed));
+    benchmarkLevel(assetDir, STRESS_BIG_LEVEL, ticks, seed, updateThreads, seeking, &big);
+    
+#ifdef MM_PROFILE
+    if (!Profiler::writeCsv("tick_profile.csv") || !Profiler::writeChromeTrace("tick_trace.json")) {
+        fprintf(stderr, "could not write the profile\n");
+        return 1;
+    }
+    printf("profile written to tick_profile.csv and tick_trace.json\n");
+#endif
+    return 0;
+}
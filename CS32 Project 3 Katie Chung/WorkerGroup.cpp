@@ -0,0 +1,73 @@
+#include "WorkerGroup.h"
+using namespace std;
+
+// loops shorter than this run on the calling thread, waking workers costs more
+const int MIN_PARALLEL_COUNT = 32;
+
+WorkerGroup::WorkerGroup(int numThreads)
+: m_func(nullptr), m_count(0), m_generation(0), m_pending(0), m_stop(false)
+{
+    for (int i = 1; i < numThreads; i++)
+        m_threads.push_back(thread(&WorkerGroup::workerLoop, this, i));
+}
+
+WorkerGroup::~WorkerGroup()
+{
+    {
+        lock_guard<mutex> guard(m_lock);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (size_t i = 0; i < m_threads.size(); i++)
+        m_threads[i].join();
+}
+
+void WorkerGroup::run(int count, const function<void(int, int)>& func) {
+    if (m_threads.empty() || count < MIN_PARALLEL_COUNT) {
+        func(0, count);
+        return;
+    }
+
+    {
+        lock_guard<mutex> guard(m_lock);
+        m_func = &func;
+        m_count = count;
+        m_pending = m_threads.size();
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    runShare(0);
+
+    unique_lock<mutex> guard(m_lock);
+    m_finished.wait(guard, [this] { return m_pending == 0; });
+    m_func = nullptr;
+}
+
+// worker index's part of the current loop
+void WorkerGroup::runShare(int index) {
+    int n = getThreadCount();
+    int begin = (long long)m_count * index / n;
+    int end = (long long)m_count * (index + 1) / n;
+    if (begin < end)
+        (*m_func)(begin, end);
+}
+
+void WorkerGroup::workerLoop(int index) {
+    unsigned int seen = 0;
+    while (true) {
+        {
+            unique_lock<mutex> guard(m_lock);
+            m_wake.wait(guard, [&] { return m_stop || m_generation != seen; });
+            if (m_stop)
+                return;
+            seen = m_generation;
+        }
+
+        runShare(index);
+
+        lock_guard<mutex> guard(m_lock);
+        if (--m_pending == 0)
+            m_finished.notify_one();
+    }
+}
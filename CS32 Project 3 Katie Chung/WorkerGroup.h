@@ -0,0 +1,44 @@
+#ifndef WORKERGROUP_H_
+#define WORKERGROUP_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+using namespace std;
+
+/*
+ A fixed set of threads that split a loop between them.
+
+ The threads are started once and sleep between calls to run(), so a world
+ can hand them work every tick without paying for thread creation. The
+ calling thread always takes the first share of the loop itself.
+ */
+
+class WorkerGroup {
+public:
+    WorkerGroup(int numThreads); // counts the calling thread
+    ~WorkerGroup();
+
+    // calls func(begin, end) on disjoint ranges covering [0, count), returns once they are all done
+    void run(int count, const function<void(int, int)>& func);
+
+    int getThreadCount() const { return m_threads.size() + 1; }
+
+private:
+    void workerLoop(int index);
+    void runShare(int index);
+
+    vector<thread> m_threads;
+    mutex m_lock;
+    condition_variable m_wake; // a new loop is ready
+    condition_variable m_finished; // every worker finished its share
+    const function<void(int, int)>* m_func;
+    int m_count;
+    unsigned int m_generation; // bumped for every loop
+    int m_pending; // workers still running their share
+    bool m_stop;
+};
+
+#endif // WORKERGROUP_H_
@@ -0,0 +1,92 @@
+#ifndef WORLDSNAPSHOT_H_
+#define WORLDSNAPSHOT_H_
+
+#include "Random.h"
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+// which pool a snapshot record goes back into
+enum SnapshotType {
+    SNAP_WALL, SNAP_EXIT, SNAP_PIT, SNAP_MARBLE, SNAP_CRYSTAL,
+    SNAP_RESTORE_HEALTH, SNAP_EXTRA_LIFE, SNAP_AMMO,
+    SNAP_FACTORY, SNAP_RAGEBOT, SNAP_REGULAR_THIEFBOT, SNAP_MEAN_THIEFBOT,
+    SNAP_PEA, SNAP_AVATAR
+};
+
+// bits of ActorRecord::flags
+const uint8_t SNAP_ALIVE = 1;
+const uint8_t SNAP_DETECTABLE = 2; // hidden actors (carried goodies) are restored invisible
+const uint8_t SNAP_MEAN = 4; // factory makes mean thiefbots
+
+// everything needed to rebuild one actor, plain data so a snapshot copies like an array
+struct ActorRecord {
+    uint32_t id;
+    int32_t slot; // where it was in its pool
+    uint8_t type; // SnapshotType
+    uint8_t flags;
+    int16_t x;
+    int16_t y;
+    int16_t direction;
+    int16_t health; // robots, avatar and marbles
+    int16_t ammo; // avatar only
+    int16_t distanceMoved; // thiefbots only
+    int16_t maxDistance; // thiefbots only
+    uint32_t goodieId; // id of the goodie a thiefbot carries, 0 if none
+};
+
+/*
+ A copy of a StudentWorld's state at one tick.
+
+ StudentWorld::takeSnapshot() fills it and restoreSnapshot() puts the world
+ back exactly as it was, including the random generator, without reloading
+ the level. Every actor is constructed again in its old pool slot, so the
+ pools and the grid allocate nothing, but each GraphObject constructor still
+ adds the actor to the framework's global set (under graphObjectMutex()),
+ which does allocate. Score and lives belong to the game rather than the
+ level, so they are not part of it.
+ */
+
+struct WorldSnapshot {
+    int level;
+    int tick;
+    unsigned int bonus;
+    int crystalsLeft;
+    bool finishLevel;
+    uint32_t nextActorId;
+    RandomGenerator rng;
+    vector<ActorRecord> actors; // avatar first, then every other actor
+};
+
+// FNV-1a over every field of a snapshot, two worlds in the same state hash the same
+inline uint64_t hashSnapshot(const WorldSnapshot& snapshot) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= 1099511628211ULL;
+        }
+    };
+    
+    mix(snapshot.level);
+    mix(snapshot.tick);
+    mix(snapshot.bonus);
+    mix(snapshot.crystalsLeft);
+    mix(snapshot.finishLevel);
+    mix(snapshot.nextActorId);
+    RandomGenerator rng = snapshot.rng; // its next output stands in for its state
+    mix(rng.next());
+    mix(rng.next());
+    for (const ActorRecord& rec : snapshot.actors) {
+        mix(rec.id);
+        mix(rec.slot);
+        mix(rec.type | (rec.flags << 8));
+        mix(uint16_t(rec.x) | (uint64_t(uint16_t(rec.y)) << 16) | (uint64_t(uint16_t(rec.direction)) << 32));
+        mix(uint16_t(rec.health) | (uint64_t(uint16_t(rec.ammo)) << 16));
+        mix(uint16_t(rec.distanceMoved) | (uint64_t(uint16_t(rec.maxDistance)) << 16));
+        mix(rec.goodieId);
+    }
+    return hash;
+}
+
+#endif // WORLDSNAPSHOT_H_